@@ -43,6 +43,14 @@ typedef Ks_AssetData (*asset_load_from_data_fn)(const Ks_UserData data);
  */
 typedef ks_no_ret (*asset_destroy_fn)(Ks_AssetData asset);
 
+/**
+ * @brief Function pointer type for measuring a loaded asset.
+ * Called without the manager's lock held, like the other callbacks.
+ * @param asset Pointer to the asset data.
+ * @return Bytes held by the asset, charged against the manager's cache budget.
+ */
+typedef ks_size (*asset_size_fn)(Ks_AssetData asset);
+
 /**
  * @brief Interface defining the lifecycle methods for a specific asset type.
  */
@@ -43,8 +43,8 @@ KS_API ks_no_ret ks_assets_manager_register_asset_type(Ks_AssetsManager am, ks_s
 /**
  * @brief Loads an asset from disk.
  *
- * If the asset is already loaded (matched by name), its reference count is incremented
- * and the existing handle is returned.
+ * If the asset is already loaded or still cached (matched by name), its reference count
+ * is incremented and the existing handle is returned.
  *
  * @param am The manager instance.
  * @param type_name Registered type name.
@@ -116,10 +116,32 @@ KS_API uint32_t ks_assets_manager_get_ref_count(Ks_AssetsManager am,
 
 /**
  * @brief Decrements the reference count of an asset.
- * If the count reaches zero, the asset is unloaded and its memory freed.
+ * If the count reaches zero and the asset type has a size function, the asset moves
+ * to the LRU cache and is only unloaded once the cache exceeds its budget.
+ * Otherwise it is unloaded and its memory freed immediately.
  */
 KS_API ks_no_ret ks_assets_manager_asset_release(Ks_AssetsManager am, Ks_Handle handle);
 
+/**
+ * @brief Sets the function measuring assets of a registered type.
+ * Only types with one are kept in the cache once released; pass NULL to
+ * unload them immediately again.
+ * @return ks_false if the type is not registered.
+ */
+KS_API ks_bool ks_assets_manager_set_asset_size_fn(Ks_AssetsManager am, ks_str type_name, asset_size_fn size_fn);
+
+/**
+ * @brief Sets the byte budget of the cache holding released assets.
+ * Least recently released assets are evicted until the cache fits.
+ * Defaults to 64 MiB; 0 disables caching and unloads everything cached.
+ */
+KS_API ks_no_ret ks_assets_manager_set_cache_budget(Ks_AssetsManager am, ks_size budget_bytes);
+
+/**
+ * @brief Gets the bytes currently held by released, cached assets.
+ */
+KS_API ks_size ks_assets_manager_get_cache_usage(Ks_AssetsManager am);
+
 /**
  * @brief Checks if a handle refers to a valid, loaded asset.
  */
@@ -1,6 +1,7 @@
 #pragma once 
 
 #include "core/types.h"
+#include "job/job.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,6 +9,13 @@ extern "C" {
 
 typedef ks_ptr Ks_Ecs_World;
 typedef ks_uint64 Ks_Entity;
+typedef ks_uint64 Ks_Component;
+typedef ks_ptr Ks_Ecs_Query;
+
+typedef struct Ks_Entity_Range {
+    const Ks_Entity* entities;
+    ks_int32 count;
+} Ks_Entity_Range;
 
 KS_API extern const Ks_Entity KS_PHASE_ON_LOAD;
 KS_API extern const Ks_Entity KS_PHASE_POST_LOAD;
@@ -24,23 +32,85 @@ typedef enum {
 } Ks_Ecs_Event;
 
 typedef void (*Ks_System_Func)(Ks_Ecs_World world, Ks_Entity entity, void* user_data);
+typedef void (*Ks_Ecs_Destroy_Func)(Ks_Ecs_World world, void* user_data);
+
+typedef struct Ks_Ecs_Iter {
+    Ks_Ecs_World world;
+    ks_int32 count;
+    const Ks_Entity* entities;
+    ks_int32 field_count;
+    ks_float delta_time;
+    void* user_data;
+    ks_ptr _impl;
+} Ks_Ecs_Iter;
+
+typedef void (*Ks_System_Iter_Func)(Ks_Ecs_Iter* it);
+
+typedef struct Ks_Ecs_System_Stats {
+    Ks_Entity system;
+    const char* name;
+    ks_uint64 invocations;
+    ks_int32 table_count;
+    ks_int32 entity_count;
+    ks_double time_ms;
+    ks_double max_time_ms;
+    ks_double total_time_ms;
+} Ks_Ecs_System_Stats;
+
+typedef ks_ptr Ks_Ecs_Snapshot_Stream;
+typedef void (*Ks_Ecs_Snapshot_Save_Func)(Ks_Ecs_World world, Ks_Component component, const void* column, ks_int32 count, Ks_Ecs_Snapshot_Stream out, void* user_data);
+typedef bool (*Ks_Ecs_Snapshot_Load_Func)(Ks_Ecs_World world, Ks_Component component, void* column, ks_int32 count, Ks_Ecs_Snapshot_Stream in, void* user_data);
+typedef void (*Ks_Ecs_Snapshot_Discard_Func)(Ks_Ecs_World world, Ks_Component component, void* column, ks_int32 count, void* user_data);
+
+typedef ks_ptr Ks_Ecs_Extract_Frame;
+
+typedef struct Ks_Ecs_Extract_Column {
+    Ks_Component component;
+    const Ks_Entity* entities;
+    const void* data;
+    ks_size stride;
+    ks_int32 count;
+} Ks_Ecs_Extract_Column;
 
 KS_API Ks_Ecs_World ks_ecs_create_world(void);
 KS_API void     ks_ecs_destroy_world(Ks_Ecs_World world);
 KS_API void     ks_ecs_progress(Ks_Ecs_World world, float delta_time);
+KS_API void     ks_ecs_set_threads(Ks_Ecs_World world, Ks_JobManager jobs, ks_uint32 worker_count);
+KS_API void     ks_ecs_on_destroy(Ks_Ecs_World world, Ks_Ecs_Destroy_Func func, void* user_data);
+KS_API void     ks_ecs_remove_on_destroy(Ks_Ecs_World world, Ks_Ecs_Destroy_Func func, void* user_data);
 
 KS_API Ks_Entity ks_ecs_create_entity(Ks_Ecs_World world, const char* name);
 KS_API void      ks_ecs_destroy_entity(Ks_Ecs_World world, Ks_Entity entity);
+KS_API Ks_Entity_Range ks_ecs_create_entities(Ks_Ecs_World world, ks_int32 count, const Ks_Component* components, ks_int32 component_count, const void* const* data_columns);
 KS_API void      ks_ecs_enable_entity(Ks_Ecs_World world, Ks_Entity entity, bool enabled);
 KS_API bool      ks_ecs_is_alive(Ks_Ecs_World world, Ks_Entity entity);
 KS_API const char* ks_ecs_get_name(Ks_Ecs_World world, Ks_Entity entity);
 KS_API Ks_Entity ks_ecs_lookup(Ks_Ecs_World world, const char* name);
 
+KS_API Ks_Entity ks_ecs_cmd_create(Ks_Ecs_World world);
+KS_API void      ks_ecs_cmd_destroy(Ks_Ecs_World world, Ks_Entity entity);
+KS_API void      ks_ecs_cmd_set(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component, const void* data);
+KS_API void      ks_ecs_cmd_remove(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component);
+KS_API void      ks_ecs_cmd_flush(Ks_Ecs_World world);
+// Commands replay in ascending key order; system callbacks get a per-chunk key
+// automatically, jobs outside systems should set one (e.g. their job index).
+KS_API void      ks_ecs_cmd_set_sort_key(ks_uint64 key);
+
 KS_API void ks_ecs_set_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name, const void* data);
 KS_API const void* ks_ecs_get_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name);
 KS_API void* ks_ecs_get_component_mut(Ks_Ecs_World world, Ks_Entity entity, const char* type_name);
 KS_API void ks_ecs_remove_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name);
 KS_API bool ks_ecs_has_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name);
+KS_API void ks_ecs_modified(Ks_Ecs_World world, Ks_Entity entity, const char* type_name);
+
+KS_API Ks_Component ks_ecs_component_id(Ks_Ecs_World world, const char* type_name);
+KS_API ks_size ks_ecs_component_size(Ks_Ecs_World world, Ks_Component component);
+KS_API void ks_ecs_set_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component, const void* data);
+KS_API const void* ks_ecs_get_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component);
+KS_API void* ks_ecs_get_component_mut_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component);
+KS_API void ks_ecs_remove_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component);
+KS_API bool ks_ecs_has_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component);
+KS_API void ks_ecs_modified_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component);
 
 KS_API void ks_ecs_add_child(Ks_Ecs_World world, Ks_Entity parent, Ks_Entity child);
 KS_API void ks_ecs_remove_child(Ks_Ecs_World world, Ks_Entity parent, Ks_Entity child);
@@ -49,6 +119,8 @@ KS_API Ks_Entity ks_ecs_get_parent(Ks_Ecs_World world, Ks_Entity child);
 KS_API Ks_Entity ks_ecs_create_prefab(Ks_Ecs_World world, const char* name);
 KS_API Ks_Entity ks_ecs_get_prefab(Ks_Ecs_World world, const char* name);
 KS_API Ks_Entity ks_ecs_instantiate(Ks_Ecs_World world, Ks_Entity prefab);
+KS_API Ks_Entity_Range ks_ecs_instantiate_n(Ks_Ecs_World world, Ks_Entity prefab, ks_int32 count, Ks_Entity* out_entities);
+KS_API bool      ks_ecs_is_prefab(Ks_Ecs_World world, Ks_Entity entity);
 
 KS_API void  ks_ecs_set_global(Ks_Ecs_World world, const char* type_name, const void* data);
 KS_API void* ks_ecs_get_global(Ks_Ecs_World world, const char* type_name);
@@ -56,7 +128,59 @@ KS_API void* ks_ecs_get_global(Ks_Ecs_World world, const char* type_name);
 KS_API void ks_ecs_create_system(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Func func, void* user_data);
 KS_API void ks_ecs_run_query(Ks_Ecs_World world, const char* filter, Ks_System_Func func, void* user_data);
 KS_API void ks_ecs_enable_system(Ks_Ecs_World world, Ks_Entity system, bool enabled);
-KS_API void ks_ecs_create_observer(Ks_Ecs_World world, Ks_Ecs_Event trigger, const char* component, Ks_System_Func func, void* user_data);
+KS_API Ks_Entity ks_ecs_create_observer(Ks_Ecs_World world, Ks_Ecs_Event trigger, const char* component, Ks_System_Func func, void* user_data);
+
+KS_API Ks_Entity ks_ecs_create_system_iter(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Iter_Func func, void* user_data);
+KS_API Ks_Entity ks_ecs_create_system_parallel(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Iter_Func func, void* user_data);
+KS_API Ks_Entity ks_ecs_create_system_changed(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Iter_Func func, void* user_data);
+KS_API void ks_ecs_run_query_iter(Ks_Ecs_World world, const char* filter, Ks_System_Iter_Func func, void* user_data);
+
+KS_API bool     ks_ecs_get_system_stats(Ks_Ecs_World world, Ks_Entity system, Ks_Ecs_System_Stats* out_stats);
+KS_API ks_int32 ks_ecs_get_all_system_stats(Ks_Ecs_World world, Ks_Ecs_System_Stats* out_stats, ks_int32 max_count);
+KS_API void     ks_ecs_reset_system_stats(Ks_Ecs_World world);
+
+KS_API void* ks_ecs_iter_field(const Ks_Ecs_Iter* it, ks_int32 index);
+KS_API ks_size ks_ecs_iter_field_size(const Ks_Ecs_Iter* it, ks_int32 index);
+KS_API bool ks_ecs_iter_field_is_set(const Ks_Ecs_Iter* it, ks_int32 index);
+KS_API bool ks_ecs_iter_field_is_self(const Ks_Ecs_Iter* it, ks_int32 index);
+KS_API Ks_Component ks_ecs_iter_field_id(const Ks_Ecs_Iter* it, ks_int32 index);
+
+#define ks_ecs_iter_field_t(it, T, index) ((T*)ks_ecs_iter_field(it, index))
+
+KS_API ks_int32 ks_ecs_filter_field_count(Ks_Ecs_World world, const char* filter);
+KS_API Ks_Ecs_Query ks_ecs_query_create(Ks_Ecs_World world, const char* filter);
+KS_API Ks_Ecs_Query ks_ecs_query_create_changed(Ks_Ecs_World world, const char* filter);
+KS_API void ks_ecs_query_destroy(Ks_Ecs_Query query);
+KS_API void ks_ecs_query_iter(Ks_Ecs_Query query, Ks_System_Iter_Func func, void* user_data);
+KS_API void ks_ecs_query_each(Ks_Ecs_Query query, Ks_System_Func func, void* user_data);
+KS_API bool ks_ecs_query_changed(Ks_Ecs_Query query);
+KS_API void ks_ecs_query_iter_changed(Ks_Ecs_Query query, Ks_System_Iter_Func func, void* user_data);
+
+// Snapshots hold every entity with at least one registered component, its
+// components, names and ChildOf/IsA links. Loading replaces those entities
+// and only touches the world once the whole buffer has been validated.
+KS_API void* ks_ecs_snapshot_save(Ks_Ecs_World world, ks_size* out_size);
+KS_API bool  ks_ecs_snapshot_load(Ks_Ecs_World world, const void* data, ks_size size);
+KS_API void  ks_ecs_snapshot_free(void* data);
+// `discard` releases a column `load` filled when the snapshot is rejected later.
+KS_API void  ks_ecs_set_snapshot_hooks(Ks_Ecs_World world, Ks_Component component, Ks_Ecs_Snapshot_Save_Func save, Ks_Ecs_Snapshot_Load_Func load, Ks_Ecs_Snapshot_Discard_Func discard, void* user_data);
+KS_API void  ks_ecs_snapshot_write(Ks_Ecs_Snapshot_Stream stream, const void* data, ks_size size);
+KS_API bool  ks_ecs_snapshot_read(Ks_Ecs_Snapshot_Stream stream, void* data, ks_size size);
+
+// Extraction copies the registered components into one of two frames after
+// each progress (or on ks_ecs_extract when auto extraction is off). acquire
+// pins the latest frame and returns NULL before the first extraction; every
+// acquired frame must be released, and its columns stay valid until then.
+// Holding a frame never blocks the simulation: while a reader still pins the
+// frame the next extraction would overwrite, that extraction is skipped and
+// ks_ecs_extract returns false, so acquire keeps returning the newest frame.
+KS_API void ks_ecs_extract_register(Ks_Ecs_World world, const char* type_name);
+KS_API void ks_ecs_extract_set_auto(Ks_Ecs_World world, bool enabled);
+KS_API bool ks_ecs_extract(Ks_Ecs_World world);
+KS_API Ks_Ecs_Extract_Frame ks_ecs_extract_acquire(Ks_Ecs_World world);
+KS_API void      ks_ecs_extract_release(Ks_Ecs_Extract_Frame frame);
+KS_API ks_uint64 ks_ecs_extract_frame_index(Ks_Ecs_Extract_Frame frame);
+KS_API bool      ks_ecs_extract_get(Ks_Ecs_Extract_Frame frame, const char* type_name, Ks_Ecs_Extract_Column* out_column);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/types.h"
+#include "ecs/ecs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef ks_ptr Ks_Ecs_Spatial;
+
+// The index follows OnSet/OnRemove and re-bins tables whose position column a
+// system wrote this frame. A write through ks_ecs_get_component_mut outside a
+// system is only picked up after ks_ecs_modified. If the world is destroyed
+// first the index is emptied, but it must still be destroyed.
+KS_API Ks_Ecs_Spatial ks_ecs_spatial_create(Ks_Ecs_World world, const char* position_type, ks_float cell_size);
+KS_API void           ks_ecs_spatial_destroy(Ks_Ecs_Spatial index);
+KS_API ks_int32       ks_ecs_spatial_count(Ks_Ecs_Spatial index);
+
+KS_API Ks_Entity_Range ks_ecs_spatial_query_radius(Ks_Ecs_Spatial index, ks_float x, ks_float y, ks_float z, ks_float radius);
+KS_API Ks_Entity_Range ks_ecs_spatial_query_aabb(Ks_Ecs_Spatial index, ks_float min_x, ks_float min_y, ks_float min_z, ks_float max_x, ks_float max_y, ks_float max_z);
+KS_API Ks_Entity_Range ks_ecs_spatial_query_nearest(Ks_Ecs_Spatial index, ks_float x, ks_float y, ks_float z, ks_int32 k);
+
+#ifdef __cplusplus
+}
+#endif
@@ -14,6 +14,23 @@ typedef struct ScriptEvent {
     const char* event_name;
 } ScriptEvent;
 
+/**
+ * @brief Exposes the manager to Lua as the `events` table.
+ *
+ * Payload passed to a Lua subscriber:
+ * - Table-backed events: the table that was published or enqueued.
+ * - Packed events (registered with a layout of int/float/double/bool fields)
+ *   published from Lua as a table: that same table.
+ * - Packed events published from C, published as a usertype instance, or
+ *   dispatched from the queue: a view of the packed payload. Each
+ *   subscription reuses one view and the next delivery overwrites it, so
+ *   copy any field that must outlive the callback. A delivery nested inside
+ *   the subscriber's own callback gets a fresh userdata instead.
+ *
+ * Both kinds read the same way (`payload.field`). Callbacks should only read
+ * fields and not rely on the payload's type, identity or writes being seen
+ * by other subscribers.
+ */
 KS_API ks_no_ret ks_event_manager_lua_bind(Ks_EventManager em, Ks_Script_Ctx ctx);
 
 #ifdef __cplusplus
@@ -22,10 +22,26 @@ typedef const void* Ks_EventData;
 
 typedef void (*Ks_EventCallback)(Ks_EventData data, void* user_data);
 
+/**
+ * @brief Receives a contiguous array of `count` payloads of the event's type.
+ * Synchronous publishes arrive as a batch of one.
+ */
+typedef void (*Ks_EventBatchCallback)(Ks_EventData data, ks_size count, void* user_data);
+
 typedef void (*Ks_UserDataFreeCallback)(void* user_data);
 
 typedef struct Ks_Signal { char _unused; } Ks_Signal;
 
+/**
+ * @brief How queued events of one type are collapsed before dispatch.
+ * Synchronous publishes are never coalesced.
+ */
+typedef enum Ks_Event_Coalesce {
+    KS_EVENT_COALESCE_NONE = 0,       ///< Every queued event is delivered.
+    KS_EVENT_COALESCE_LATEST,         ///< Only the last queued payload of the frame is delivered.
+    KS_EVENT_COALESCE_LATEST_PER_KEY  ///< The last payload per key is delivered; unkeyed events count as one key.
+} Ks_Event_Coalesce;
+
 /**
  * @brief Creates an Event Manager.
  */
@@ -35,6 +51,20 @@ KS_API ks_no_ret ks_event_manager_destroy(Ks_EventManager em);
 KS_API Ks_Handle ks_event_manager_register_type(Ks_EventManager em, const char* type_name);
 KS_API Ks_Handle ks_event_manager_register_signal(Ks_EventManager em, const char* signal_name);
 
+/**
+ * @brief Registers an event whose queued publishes collapse to the latest payload.
+ * Registering an existing name updates its coalescing mode. Set it before enqueueing.
+ */
+KS_API Ks_Handle ks_event_manager_register_type_ex(Ks_EventManager em, const char* type_name, Ks_Event_Coalesce coalesce);
+KS_API Ks_Handle ks_event_manager_register_signal_ex(Ks_EventManager em, const char* signal_name, Ks_Event_Coalesce coalesce);
+
+/**
+ * @brief Called on the dispatching thread for every queued payload of the event
+ * once it is no longer needed: after dispatch, when overwritten by coalescing,
+ * or when the manager is destroyed. Lets payloads own external resources.
+ */
+KS_API void ks_event_manager_set_queued_release(Ks_EventManager em, Ks_Handle event_handle, Ks_EventCallback release, void* user_data);
+
 /**
  * @brief Retrieves the handle for a registered event.
  */
@@ -65,9 +95,30 @@ KS_API Ks_Handle ks_event_manager_subscribe_ex(
     Ks_UserDataFreeCallback free_cb
 );
 
+/**
+ * @brief Subscribes a batch callback to an event.
+ * Queued events of this type are delivered in one call per dispatch.
+ */
+KS_API Ks_Handle ks_event_manager_subscribe_batch(Ks_EventManager em, Ks_Handle event_handle, Ks_EventBatchCallback callback, void* user_data);
+
+/**
+ * @brief Subscribes to an event for a single 64-bit key (e.g. an entity id).
+ * The callback only runs for ks_event_manager_publish_keyed with a matching key;
+ * plain publishes do not reach keyed subscribers.
+ */
+KS_API Ks_Handle ks_event_manager_subscribe_keyed(
+    Ks_EventManager em,
+    Ks_Handle event_handle,
+    ks_uint64 key,
+    Ks_EventCallback callback,
+    void* user_data,
+    Ks_UserDataFreeCallback free_cb
+);
 
 /**
  * @brief Unsubscribes from an event.
+ * The subscriber's free_cb runs once no publish can still reach it: when the last
+ * publish in flight returns, or at the latest during the next dispatch_queued.
  */
 KS_API ks_no_ret ks_event_manager_unsubscribe(Ks_EventManager em, Ks_Handle subscription);
 
@@ -77,8 +128,46 @@ KS_API void ks_event_manager_publish(
     const void* data_ptr
 );
 
+/**
+ * @brief Publishes to the subscribers of `key`, then to the unkeyed subscribers of the event.
+ */
+KS_API void ks_event_manager_publish_keyed(
+    Ks_EventManager em,
+    Ks_Handle event_handle,
+    ks_uint64 key,
+    const void* data_ptr
+);
+
 KS_API void ks_event_manager_emit(Ks_EventManager em, Ks_Handle signal_handle);
 
+/**
+ * @brief Copies a payload into the calling thread's queue for deferred dispatch.
+ * Safe to call from job workers; lock-free after the thread's first enqueue.
+ * Events from one thread keep their relative order.
+ * @param size Must match the reflected size of the event type. Pass NULL/0 for signals.
+ */
+KS_API void ks_event_manager_enqueue(Ks_EventManager em, Ks_Handle event_handle, const void* data_ptr, ks_size size);
+
+/**
+ * @brief Enqueues a payload for `key`. At dispatch it reaches the subscribers of `key`
+ * and the unkeyed subscribers, like ks_event_manager_publish_keyed.
+ */
+KS_API void ks_event_manager_enqueue_keyed(Ks_EventManager em, Ks_Handle event_handle, ks_uint64 key, const void* data_ptr, ks_size size);
+
+/**
+ * @brief Stamps queued events with a global sequence number so dispatch
+ * restores publish order across threads. Off by default.
+ */
+KS_API void ks_event_manager_set_sequenced(Ks_EventManager em, ks_bool enabled);
+
+/**
+ * @brief Sync point: merges all per-thread queues and dispatches them on the calling thread,
+ * grouped by event type in order of first enqueue.
+ * Events enqueued during dispatch are delivered on the next call.
+ * Also frees any subscriber lists and user data retired since the last call.
+ */
+KS_API void ks_event_manager_dispatch_queued(Ks_EventManager em);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+/**
+ * @file events_recorder.h
+ * @brief Recording and replay of published event streams.
+ * A log captures each event's name, timestamp and payload bytes so a
+ * production session can be replayed later as a benchmark driver.
+ * @ingroup Events
+ */
+#pragma once
+
+#include "events_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef ks_ptr Ks_EventLog;
+
+typedef enum Ks_Event_Log_Flags {
+    KS_EVENT_LOG_KEYED    = 1 << 0, ///< Published or enqueued with a key.
+    KS_EVENT_LOG_QUEUED   = 1 << 1, ///< Enqueued rather than published synchronously.
+    KS_EVENT_LOG_DISPATCH = 1 << 2  ///< Marker for a ks_event_manager_dispatch_queued call.
+} Ks_Event_Log_Flags;
+
+typedef enum Ks_Event_Replay_Speed {
+    KS_EVENT_REPLAY_ORIGINAL = 0, ///< Waits out the recorded gaps between events.
+    KS_EVENT_REPLAY_MAX           ///< Publishes back to back.
+} Ks_Event_Replay_Speed;
+
+KS_API Ks_EventLog ks_event_log_create(void);
+KS_API ks_no_ret ks_event_log_destroy(Ks_EventLog log);
+
+KS_API ks_size ks_event_log_count(Ks_EventLog log);
+
+/**
+ * @brief Time between the first and the last recorded event, in nanoseconds.
+ */
+KS_API ks_uint64 ks_event_log_duration_ns(Ks_EventLog log);
+
+/**
+ * @brief Appends one event, timestamped now. Not thread-safe; the manager serializes its own appends.
+ * Payload bytes are stored only when the reflected type of `event_name` holds no pointers,
+ * other events keep their timing but are skipped on replay.
+ * @param event_name Registered event name, or NULL for a dispatch marker.
+ * @param flags Combination of Ks_Event_Log_Flags.
+ */
+KS_API ks_no_ret ks_event_log_append(Ks_EventLog log, ks_str event_name, const void* data_ptr, ks_uint32 flags, ks_uint64 key);
+
+/**
+ * @brief Appends one event captured earlier at `time_ns` (from ks_event_log_now_ns).
+ * Events must be appended in time order; an earlier timestamp is clamped to the last one.
+ */
+KS_API ks_no_ret ks_event_log_append_at(Ks_EventLog log, ks_uint64 time_ns, ks_str event_name, const void* data_ptr, ks_uint32 flags, ks_uint64 key);
+
+/**
+ * @brief Current steady-clock time in nanoseconds, the timebase of ks_event_log_append_at.
+ */
+KS_API ks_uint64 ks_event_log_now_ns(void);
+
+/**
+ * @brief Starts appending every publish, enqueue and queued dispatch of `em` to `log`.
+ * Replaces any log already attached. The log must outlive the recording.
+ * Events are buffered per thread and reach the log when recording stops or is
+ * moved to another log. Events published or enqueued by a subscriber callback
+ * are not recorded, since replaying the outer event emits them again.
+ */
+KS_API ks_no_ret ks_event_manager_record_start(Ks_EventManager em, Ks_EventLog log);
+
+/**
+ * @brief Flushes the buffered events into the log and detaches it.
+ * No event is appended once this returns.
+ */
+KS_API ks_no_ret ks_event_manager_record_stop(Ks_EventManager em);
+
+/**
+ * @brief Serializes the log into a buffer released with ks_event_log_free.
+ */
+KS_API void* ks_event_log_save(Ks_EventLog log, ks_size* out_size);
+KS_API Ks_EventLog ks_event_log_load(const void* data, ks_size size);
+KS_API ks_no_ret ks_event_log_free(void* data);
+
+/**
+ * @brief Re-publishes the log into `em` on the calling thread.
+ * Events are matched by name; types missing from `em` or reflected with a
+ * different size are skipped, as are events recorded without payload.
+ * @return The number of events replayed, dispatch markers excluded.
+ */
+KS_API ks_size ks_event_log_replay(Ks_EventLog log, Ks_EventManager em, Ks_Event_Replay_Speed speed);
+
+#ifdef __cplusplus
+}
+#endif
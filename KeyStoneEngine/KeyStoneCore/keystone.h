@@ -17,6 +17,7 @@
 #include "./include/event/event.h"
 #include "./include/event/events_manager.h"
 #include "./include/event/events_binding.h"
+#include "./include/event/events_recorder.h"
 #include "./include/state/state_manager.h"
 #include "./include/state/state.h"
 #include "./include/state/state_binding.h"
@@ -30,4 +31,5 @@
 #include "./include/job/job.h"
 #include "./include/ecs/ecs.h"
 #include "./include/ecs/ecs_binding.h"
+#include "./include/ecs/spatial.h"
 #include "./include/profiler/profiler.h"
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <map>
 #include <tuple>
+#include <vector>
 
 #include <assert.h>
 #include <atomic>
@@ -16,15 +17,49 @@
 #include "memory/memory.h"
 #include "core/log.h"
 
+#define KS_HANDLE_INDEX_MASK 0x00FFFFFF
+
+// Asset handles pack a slot index and a generation under the handle type id.
+// Slots live in fixed pages that are never moved, so data, state and validity
+// lookups resolve a handle without taking assets_mutex: the live generation is
+// read before and after the field, and a slot recycled in between fails the
+// second check. Load, release and reload still mutate slots under the lock.
+// A slot whose generation is exhausted is set aside instead of wrapping, so a
+// stale handle cannot alias a new asset until every slot has run out.
+static constexpr uint32_t KS_ASSET_SLOT_BITS = 14;
+static constexpr uint32_t KS_ASSET_SLOT_MASK = (1u << KS_ASSET_SLOT_BITS) - 1;
+static constexpr uint32_t KS_ASSET_GEN_MASK = KS_HANDLE_INDEX_MASK >> KS_ASSET_SLOT_BITS;
+static constexpr uint32_t KS_ASSET_PAGE_BITS = 8;
+static constexpr uint32_t KS_ASSET_PAGE_SIZE = 1u << KS_ASSET_PAGE_BITS;
+static constexpr uint32_t KS_ASSET_PAGE_COUNT = (KS_ASSET_SLOT_MASK + 1) >> KS_ASSET_PAGE_BITS;
+static constexpr uint32_t KS_ASSET_NO_SLOT = 0xFFFFFFFF;
+
+// Released assets whose type reports a size stay loaded in an LRU list, linked
+// through their slots, until the cached bytes exceed the budget.
+static constexpr ks_size KS_ASSET_DEFAULT_CACHE_BUDGET = 64ull * 1024 * 1024;
+
 typedef struct Ks_AssetEntry {
-	Ks_AssetData data;
+	std::atomic<Ks_AssetData> data{ nullptr };
+	std::atomic<Ks_AssetState> state{ KS_ASSET_STATE_NONE };
+	std::atomic<uint32_t> live_generation{ 0 }; // 0 while the slot is free
+	uint32_t generation = 0;
+	uint32_t next_free = KS_ASSET_NO_SLOT;
 	std::string asset_name;
 	std::string type_name;
 	std::string source_path;
-	uint32_t ref_count;
-	Ks_AssetState state;
+	uint32_t ref_count = 0;
+	bool cached = false;
+	ks_size cached_size = 0;
+	uint32_t lru_prev = KS_ASSET_NO_SLOT;
+	uint32_t lru_next = KS_ASSET_NO_SLOT;
 } Ks_AssetEntry;
 
+struct AssetRemoval {
+	std::string type_name;
+	std::string source_path;
+	Ks_AssetData data;
+};
+
 struct AsyncLoadPayload {
 	class AssetManager_Impl* mgr;
 	Ks_Handle handle;
@@ -43,7 +78,8 @@ public:
 	);
 
 	Ks_IAsset get_asset_interface(const std::string& type_name);
-	void register_asset(Ks_Handle handle, Ks_AssetEntry& entry);
+	bool set_size_fn(const std::string& type_name, asset_size_fn size_fn);
+	Ks_Handle register_asset(const std::string& type_name, const std::string& asset_name, const std::string& source_path, Ks_AssetData data, Ks_AssetState state);
 
 	Ks_Handle load_sync(const std::string& type_name, const std::string& name, const std::string& path);
 	Ks_Handle load_async(const std::string& type_name, const std::string& name, const std::string& path, Ks_JobManager js);
@@ -56,7 +92,6 @@ public:
 	void update();
 
 	Ks_Handle get_asset(const std::string& asset_name);
-	Ks_Handle generate_handle();
 
 	Ks_AssetData get_asset_data_from_handle(Ks_Handle handle);
 	std::string  get_asset_name_from_handle(Ks_Handle handle);
@@ -66,32 +101,60 @@ public:
 	Ks_AssetState get_asset_state_from_handle(Ks_Handle handle);
 
 	Ks_IAsset get_asset_interface_nolock(const std::string& type_name);
+	Ks_AssetEntry* get_entry_nolock(Ks_Handle handle);
+	void acquire_entry_nolock(Ks_AssetEntry& entry);
 
 	bool is_handle_valid(Ks_Handle handle);
 
 	void acquire_asset(Ks_Handle handle);
 	void release_asset(Ks_Handle handle);
 
+	void set_cache_budget(ks_size budget_bytes);
+	ks_size get_cache_usage();
+
 	Ks_FileWatcher get_watcher();
 	std::string resolve_path(const std::string& input_path);
 
 private:
+	Ks_AssetEntry* slot_from_handle(Ks_Handle handle) const;
+	Ks_AssetEntry* slot_from_index(uint32_t slot) const;
+	void free_slot(Ks_AssetEntry& entry, uint32_t slot);
+	void push_free_slot(Ks_AssetEntry& entry, uint32_t slot);
+
+	void cache_link(Ks_AssetEntry& entry, uint32_t slot);
+	void cache_unlink(Ks_AssetEntry& entry);
+	void evict_to_budget_nolock(std::vector<AssetRemoval>& out);
+	void remove_entry_nolock(Ks_AssetEntry& entry, uint32_t slot, std::vector<AssetRemoval>& out);
+	void finish_removals(const std::vector<AssetRemoval>& removals);
+
 	std::mutex assets_mutex;
 	Ks_FileWatcher file_watcher = nullptr;
 	std::unordered_map<std::string, Ks_Handle> path_to_handle;
 	std::unordered_map<std::string, Ks_IAsset> assets_interfaces;
-	std::unordered_map<Ks_Handle, Ks_AssetEntry> assets_entries;
+	std::unordered_map<std::string, asset_size_fn> assets_size_fns;
 	std::unordered_map<std::string, Ks_Handle> assets_name_to_handle;
 
+	std::atomic<Ks_AssetEntry*> slot_pages[KS_ASSET_PAGE_COUNT] = {};
+	uint32_t slot_count = 0;
+	uint32_t free_head = KS_ASSET_NO_SLOT;
+	uint32_t free_tail = KS_ASSET_NO_SLOT;
+	std::vector<uint32_t> saturated_slots;
+
+	uint32_t lru_head = KS_ASSET_NO_SLOT;
+	uint32_t lru_tail = KS_ASSET_NO_SLOT;
+	ks_size cache_budget = KS_ASSET_DEFAULT_CACHE_BUDGET;
+	ks_size cache_usage = 0;
+
 	Ks_Handle_Id asset_type_id;
 };
 
 enum AssetsError {
 	FAILED_TO_REGISTER_ASSET,
 	INVALID_ASSET_INTERFACE,
-	INVALID_ASSET_HANDLE, 
+	INVALID_ASSET_HANDLE,
 	RELEASE_DATA_ON_ASYNC_LOAD,
-	FAILED_ASYNC_LOAD
+	FAILED_ASYNC_LOAD,
+	TOO_MANY_ASSETS
 };
 
 static void on_asset_file_changed(ks_str path, ks_ptr user_data) {
@@ -99,6 +162,19 @@ static void on_asset_file_changed(ks_str path, ks_ptr user_data) {
 	am->reload_asset(path);
 }
 
+static uint32_t get_generation_from_handle(Ks_Handle handle) {
+	return (handle & KS_HANDLE_INDEX_MASK) >> KS_ASSET_SLOT_BITS;
+}
+
+// Lock-free read of one slot field on behalf of `generation`. The acquire on
+// the field keeps the second generation load after it.
+template<typename T>
+static bool read_live_field(const Ks_AssetEntry* entry, uint32_t generation, const std::atomic<T>& field, T& out) {
+	if (entry->live_generation.load(std::memory_order_acquire) != generation) return false;
+	out = field.load(std::memory_order_acquire);
+	return entry->live_generation.load(std::memory_order_acquire) == generation;
+}
+
 AssetManager_Impl::AssetManager_Impl()
 	: asset_type_id(KS_INVALID_ID)
 	, file_watcher(nullptr)
@@ -115,43 +191,96 @@ AssetManager_Impl::AssetManager_Impl()
 }
 
 AssetManager_Impl::~AssetManager_Impl() {
-	if (file_watcher) {
-		for (auto& [handle, entry] : assets_entries) {
-			if (!entry.source_path.empty()) {
-				ks_file_watcher_unwatch_file(file_watcher, entry.source_path.c_str());
-			}
-		}
-		ks_file_watcher_destroy(file_watcher);
-		file_watcher = nullptr;
-	}
-
+	std::vector<std::string> to_unwatch;
 	std::vector<std::pair<std::string, Ks_AssetData>> to_destroy;
 
 	{
 		std::lock_guard<std::mutex> lock(assets_mutex);
 
-		for (auto& [handle, entry] : assets_entries) {
-			if (entry.data) {
-				to_destroy.emplace_back(entry.type_name, entry.data);
-				entry.data = nullptr;
+		for (uint32_t slot = 0; slot < slot_count; ++slot) {
+			Ks_AssetEntry& entry = *slot_from_index(slot);
+			if (entry.live_generation.load(std::memory_order_relaxed) == 0) continue;
+
+			if (!entry.source_path.empty()) {
+				to_unwatch.push_back(entry.source_path);
+			}
+			Ks_AssetData data = entry.data.exchange(nullptr);
+			if (data) {
+				to_destroy.emplace_back(entry.type_name, data);
 			}
 		}
 
-		assets_entries.clear();
 		assets_name_to_handle.clear();
 		path_to_handle.clear();
 	}
 
+	if (file_watcher) {
+		for (const std::string& path : to_unwatch) {
+			ks_file_watcher_unwatch_file(file_watcher, path.c_str());
+		}
+		ks_file_watcher_destroy(file_watcher);
+		file_watcher = nullptr;
+	}
+
 	for (auto& [type_name, data] : to_destroy) {
 		auto it = assets_interfaces.find(type_name);
 		if (it != assets_interfaces.end() && it->second.destroy_fn) {
 			it->second.destroy_fn(data);
 		}
 	}
+
+	for (auto& page_ptr : slot_pages) {
+		Ks_AssetEntry* page = page_ptr.load(std::memory_order_relaxed);
+		if (!page) continue;
+		for (uint32_t i = 0; i < KS_ASSET_PAGE_SIZE; ++i) {
+			page[i].~Ks_AssetEntry();
+		}
+		ks_dealloc(page);
+	}
 }
 
-Ks_Handle AssetManager_Impl::generate_handle() {
-	return ks_handle_make(asset_type_id);
+Ks_AssetEntry* AssetManager_Impl::slot_from_index(uint32_t slot) const {
+	Ks_AssetEntry* page = slot_pages[slot >> KS_ASSET_PAGE_BITS].load(std::memory_order_acquire);
+	if (!page) return nullptr;
+	return &page[slot & (KS_ASSET_PAGE_SIZE - 1)];
+}
+
+Ks_AssetEntry* AssetManager_Impl::slot_from_handle(Ks_Handle handle) const {
+	if (!ks_handle_is_type(handle, asset_type_id)) return nullptr;
+	return slot_from_index(handle & KS_ASSET_SLOT_MASK);
+}
+
+Ks_AssetEntry* AssetManager_Impl::get_entry_nolock(Ks_Handle handle) {
+	Ks_AssetEntry* entry = slot_from_handle(handle);
+	if (!entry) return nullptr;
+	if (entry->live_generation.load(std::memory_order_relaxed) != get_generation_from_handle(handle)) return nullptr;
+	return entry;
+}
+
+void AssetManager_Impl::push_free_slot(Ks_AssetEntry& entry, uint32_t slot) {
+	entry.next_free = KS_ASSET_NO_SLOT;
+	if (free_tail != KS_ASSET_NO_SLOT) slot_from_index(free_tail)->next_free = slot;
+	else free_head = slot;
+	free_tail = slot;
+}
+
+// Slots are reused in FIFO order so a generation takes as long as possible
+// to come around again. Saturated slots only return once the slot space is
+// exhausted, after at least (slots * generations) registrations.
+void AssetManager_Impl::free_slot(Ks_AssetEntry& entry, uint32_t slot) {
+	entry.live_generation.store(0);
+	entry.data.store(nullptr);
+	entry.state.store(KS_ASSET_STATE_NONE);
+	entry.asset_name.clear();
+	entry.type_name.clear();
+	entry.source_path.clear();
+	entry.ref_count = 0;
+
+	if (entry.generation == KS_ASSET_GEN_MASK) {
+		saturated_slots.push_back(slot);
+		return;
+	}
+	push_free_slot(entry, slot);
 }
 
 std::string AssetManager_Impl::resolve_path(const std::string& input_path) {
@@ -176,99 +305,190 @@ Ks_IAsset AssetManager_Impl::get_asset_interface_nolock(const std::string& type_
 
 Ks_AssetData AssetManager_Impl::get_asset_data_from_handle(Ks_Handle handle)
 {
-	KS_PROFILE_SCOPE("Asset_GetData_Lock");
-	std::lock_guard<std::mutex> lock(assets_mutex);
-	auto found = assets_entries.find(handle);
-	if (found == assets_entries.end()) return nullptr;
-	return found->second.data;
+	Ks_AssetEntry* entry = slot_from_handle(handle);
+	if (!entry) return nullptr;
+
+	Ks_AssetData data = nullptr;
+	if (!read_live_field(entry, get_generation_from_handle(handle), entry->data, data)) return nullptr;
+	return data;
 }
 
 std::string AssetManager_Impl::get_asset_name_from_handle(Ks_Handle handle)
 {
 	std::lock_guard<std::mutex> lock(assets_mutex);
-	auto found = assets_entries.find(handle);
-	if (found == assets_entries.end()) return "";
-	return found->second.asset_name;
+	Ks_AssetEntry* entry = get_entry_nolock(handle);
+	if (!entry) return "";
+	return entry->asset_name;
 }
 
 std::string AssetManager_Impl::get_asset_type_from_handle(Ks_Handle handle)
 {
 	std::lock_guard<std::mutex> lock(assets_mutex);
 	static std::string empty = "";
-	auto found = assets_entries.find(handle);
-	if (found == assets_entries.end()) return empty;
-	return found->second.type_name;
+	Ks_AssetEntry* entry = get_entry_nolock(handle);
+	if (!entry) return empty;
+	return entry->type_name;
 }
 
 const char* AssetManager_Impl::get_asset_type_from_handle_raw(Ks_Handle handle) {
 	std::lock_guard<std::mutex> lock(assets_mutex);
-	auto found = assets_entries.find(handle);
-	if (found == assets_entries.end()) return nullptr;
-	return found->second.type_name.c_str();
+	Ks_AssetEntry* entry = get_entry_nolock(handle);
+	if (!entry) return nullptr;
+	return entry->type_name.c_str();
 }
 
 uint32_t AssetManager_Impl::get_asset_ref_count_from_handle(Ks_Handle handle)
 {
 	std::lock_guard<std::mutex> lock(assets_mutex);
-	auto found = assets_entries.find(handle);
-	if (found == assets_entries.end()) return 0;
-	return found->second.ref_count;
+	Ks_AssetEntry* entry = get_entry_nolock(handle);
+	if (!entry) return 0;
+	return entry->ref_count;
 }
 
 bool AssetManager_Impl::is_handle_valid(Ks_Handle handle)
 {
-	std::lock_guard<std::mutex> lock(assets_mutex);
-	if (!ks_handle_is_type(handle, asset_type_id)) return false;
-	return assets_entries.find(handle) != assets_entries.end();
+	Ks_AssetEntry* entry = slot_from_handle(handle);
+	if (!entry) return false;
+	return entry->live_generation.load(std::memory_order_acquire) == get_generation_from_handle(handle);
+}
+
+// Requesting a cached asset again takes it back out of the LRU list; nothing is reloaded.
+void AssetManager_Impl::acquire_entry_nolock(Ks_AssetEntry& entry)
+{
+	if (entry.cached) cache_unlink(entry);
+	entry.ref_count++;
 }
 
 void AssetManager_Impl::acquire_asset(Ks_Handle handle)
 {
 	std::lock_guard<std::mutex> lock(assets_mutex);
-	auto found = assets_entries.find(handle);
-	if (found != assets_entries.end()) {
-		found->second.ref_count++;
+	Ks_AssetEntry* entry = get_entry_nolock(handle);
+	if (entry) {
+		acquire_entry_nolock(*entry);
 	}
 }
 
-void AssetManager_Impl::release_asset(Ks_Handle handle) {
-	std::string type_name_to_destroy;
-	Ks_AssetData data_to_destroy = nullptr;
-	std::string asset_name_to_remove;
-	std::string source_path_to_unwatch;
+void AssetManager_Impl::cache_link(Ks_AssetEntry& entry, uint32_t slot) {
+	entry.cached = true;
+	entry.lru_prev = KS_ASSET_NO_SLOT;
+	entry.lru_next = lru_head;
+	if (lru_head != KS_ASSET_NO_SLOT) slot_from_index(lru_head)->lru_prev = slot;
+	else lru_tail = slot;
+	lru_head = slot;
+	cache_usage += entry.cached_size;
+}
 
-	{
-		std::lock_guard<std::mutex> lock(assets_mutex);
-		auto found = assets_entries.find(handle);
-		if (found == assets_entries.end()) return;
+void AssetManager_Impl::cache_unlink(Ks_AssetEntry& entry) {
+	if (entry.lru_prev != KS_ASSET_NO_SLOT) slot_from_index(entry.lru_prev)->lru_next = entry.lru_next;
+	else lru_head = entry.lru_next;
+	if (entry.lru_next != KS_ASSET_NO_SLOT) slot_from_index(entry.lru_next)->lru_prev = entry.lru_prev;
+	else lru_tail = entry.lru_prev;
 
-		Ks_AssetEntry& entry = found->second;
-		entry.ref_count--;
+	cache_usage -= entry.cached_size;
+	entry.cached = false;
+	entry.cached_size = 0;
+	entry.lru_prev = KS_ASSET_NO_SLOT;
+	entry.lru_next = KS_ASSET_NO_SLOT;
+}
 
-		if (entry.ref_count == 0) {
-			type_name_to_destroy = entry.type_name;
-			data_to_destroy = entry.data;
-			asset_name_to_remove = entry.asset_name;
-			source_path_to_unwatch = entry.source_path;
+void AssetManager_Impl::evict_to_budget_nolock(std::vector<AssetRemoval>& out) {
+	while (cache_usage > cache_budget && lru_tail != KS_ASSET_NO_SLOT) {
+		uint32_t slot = lru_tail;
+		remove_entry_nolock(*slot_from_index(slot), slot, out);
+	}
+}
 
-			if (!entry.source_path.empty()) {
-				path_to_handle.erase(entry.source_path);
+void AssetManager_Impl::remove_entry_nolock(Ks_AssetEntry& entry, uint32_t slot, std::vector<AssetRemoval>& out) {
+	if (entry.cached) cache_unlink(entry);
+
+	out.push_back({ entry.type_name, entry.source_path, entry.data.load(std::memory_order_relaxed) });
+	if (!entry.source_path.empty()) {
+		path_to_handle.erase(entry.source_path);
+	}
+	assets_name_to_handle.erase(entry.asset_name);
+	free_slot(entry, slot);
+}
+
+// Unwatching and destroy callbacks run outside assets_mutex.
+void AssetManager_Impl::finish_removals(const std::vector<AssetRemoval>& removals) {
+	for (const AssetRemoval& removal : removals) {
+		if (!removal.source_path.empty() && file_watcher) {
+			ks_file_watcher_unwatch_file(file_watcher, removal.source_path.c_str());
+		}
+
+		if (removal.data) {
+			auto it = assets_interfaces.find(removal.type_name);
+			if (it != assets_interfaces.end() && it->second.destroy_fn) {
+				it->second.destroy_fn(removal.data);
 			}
-			assets_name_to_handle.erase(entry.asset_name);
-			assets_entries.erase(found);
 		}
 	}
+}
 
-	if (!source_path_to_unwatch.empty() && file_watcher) {
-		ks_file_watcher_unwatch_file(file_watcher, source_path_to_unwatch.c_str());
-	}
+// The size function runs outside assets_mutex while the last reference still
+// keeps the asset loaded. If the data is no longer the one measured when the
+// lock is taken again (a reload swapped it, or more references came and
+// went), it is measured again before the reference is dropped.
+void AssetManager_Impl::release_asset(Ks_Handle handle) {
+	std::vector<AssetRemoval> removals;
+	Ks_AssetData measured = nullptr;
+	ks_size measured_size = 0;
+
+	for (;;) {
+		asset_size_fn size_fn = nullptr;
+		Ks_AssetData data = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(assets_mutex);
+			Ks_AssetEntry* found = get_entry_nolock(handle);
+			if (!found || found->ref_count == 0) return;
+
+			Ks_AssetEntry& entry = *found;
+			data = entry.data.load(std::memory_order_relaxed);
+			if (entry.ref_count == 1 && data && cache_budget > 0
+				&& entry.state.load(std::memory_order_relaxed) == KS_ASSET_STATE_READY) {
+				auto it = assets_size_fns.find(entry.type_name);
+				if (it != assets_size_fns.end()) size_fn = it->second;
+			}
 
-	if (data_to_destroy) {
-		auto it = assets_interfaces.find(type_name_to_destroy);
-		if (it != assets_interfaces.end() && it->second.destroy_fn) {
-			it->second.destroy_fn(data_to_destroy);
+			if (!size_fn || data == measured) {
+				entry.ref_count--;
+				if (entry.ref_count == 0) {
+					uint32_t slot = handle & KS_ASSET_SLOT_MASK;
+					if (size_fn && measured_size <= cache_budget) {
+						entry.cached_size = measured_size;
+						cache_link(entry, slot);
+						evict_to_budget_nolock(removals);
+					}
+					else {
+						entry.cached_size = 0;
+						remove_entry_nolock(entry, slot, removals);
+					}
+				}
+				break;
+			}
 		}
+		measured = data;
+		measured_size = size_fn(data);
 	}
+
+	finish_removals(removals);
+}
+
+void AssetManager_Impl::set_cache_budget(ks_size budget_bytes) {
+	std::vector<AssetRemoval> removals;
+
+	{
+		std::lock_guard<std::mutex> lock(assets_mutex);
+		cache_budget = budget_bytes;
+		evict_to_budget_nolock(removals);
+	}
+
+	finish_removals(removals);
+}
+
+ks_size AssetManager_Impl::get_cache_usage() {
+	std::lock_guard<std::mutex> lock(assets_mutex);
+	return cache_usage;
 }
 
 Ks_FileWatcher AssetManager_Impl::get_watcher()
@@ -282,6 +502,15 @@ void AssetManager_Impl::register_interface(const std::string& type_name, Ks_IAss
 	assets_interfaces.emplace(type_name, asset_interface);
 }
 
+bool AssetManager_Impl::set_size_fn(const std::string& type_name, asset_size_fn size_fn)
+{
+	std::lock_guard<std::mutex> lock(assets_mutex);
+	if (assets_interfaces.find(type_name) == assets_interfaces.end()) return false;
+	if (size_fn) assets_size_fns[type_name] = size_fn;
+	else assets_size_fns.erase(type_name);
+	return true;
+}
+
 Ks_IAsset AssetManager_Impl::get_asset_interface(const std::string& type_name)
 {
 	std::lock_guard<std::mutex> lock(assets_mutex);
@@ -289,20 +518,68 @@ Ks_IAsset AssetManager_Impl::get_asset_interface(const std::string& type_name)
 }
 
 Ks_AssetState AssetManager_Impl::get_asset_state_from_handle(Ks_Handle handle) {
-	std::lock_guard<std::mutex> lock(assets_mutex);
-	auto found = assets_entries.find(handle);
-	if (found == assets_entries.end()) return KS_ASSET_STATE_NONE;
-	return found->second.state;
+	Ks_AssetEntry* entry = slot_from_handle(handle);
+	if (!entry) return KS_ASSET_STATE_NONE;
+
+	Ks_AssetState state = KS_ASSET_STATE_NONE;
+	if (!read_live_field(entry, get_generation_from_handle(handle), entry->state, state)) return KS_ASSET_STATE_NONE;
+	return state;
 }
 
-void AssetManager_Impl::register_asset(Ks_Handle handle, Ks_AssetEntry& entry)
+// Called with assets_mutex held. The slot's fields are written before its
+// generation goes live, so a reader never sees a half-built entry.
+Ks_Handle AssetManager_Impl::register_asset(const std::string& type_name, const std::string& asset_name, const std::string& source_path, Ks_AssetData data, Ks_AssetState state)
 {
-	assets_entries.emplace(handle, entry);
-	assets_name_to_handle.emplace(entry.asset_name, handle);
+	if (free_head == KS_ASSET_NO_SLOT && slot_count > KS_ASSET_SLOT_MASK && !saturated_slots.empty()) {
+		KS_LOG_WARN("[Assets] Asset handles exhausted, recycling %zu saturated slots", saturated_slots.size());
+		for (uint32_t saturated : saturated_slots) {
+			Ks_AssetEntry* entry = slot_from_index(saturated);
+			entry->generation = 0;
+			push_free_slot(*entry, saturated);
+		}
+		saturated_slots.clear();
+	}
 
-	if (!entry.source_path.empty()) {
-		path_to_handle[entry.source_path] = handle;
+	uint32_t slot = free_head;
+	if (slot != KS_ASSET_NO_SLOT) {
+		free_head = slot_from_index(slot)->next_free;
+		if (free_head == KS_ASSET_NO_SLOT) free_tail = KS_ASSET_NO_SLOT;
+	}
+	else {
+		if (slot_count > KS_ASSET_SLOT_MASK) {
+			ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "AssetManager", AssetsError::TOO_MANY_ASSETS, "Cannot register asset '%s': more than %u live assets", asset_name.c_str(), KS_ASSET_SLOT_MASK + 1);
+			return KS_INVALID_HANDLE;
+		}
+
+		slot = slot_count++;
+		std::atomic<Ks_AssetEntry*>& page_ptr = slot_pages[slot >> KS_ASSET_PAGE_BITS];
+		if (!page_ptr.load(std::memory_order_relaxed)) {
+			Ks_AssetEntry* page = (Ks_AssetEntry*)ks_alloc(sizeof(Ks_AssetEntry) * KS_ASSET_PAGE_SIZE, KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA);
+			for (uint32_t i = 0; i < KS_ASSET_PAGE_SIZE; ++i) {
+				new (&page[i]) Ks_AssetEntry();
+			}
+			page_ptr.store(page, std::memory_order_release);
+		}
+	}
+
+	Ks_AssetEntry& entry = *slot_from_index(slot);
+	entry.generation++;
+	entry.next_free = KS_ASSET_NO_SLOT;
+	entry.asset_name = asset_name;
+	entry.type_name = type_name;
+	entry.source_path = source_path;
+	entry.ref_count = 1;
+	entry.data.store(data);
+	entry.state.store(state);
+	entry.live_generation.store(entry.generation);
+
+	Ks_Handle handle = ((Ks_Handle)asset_type_id << 24) | (entry.generation << KS_ASSET_SLOT_BITS) | slot;
+	assets_name_to_handle.emplace(asset_name, handle);
+
+	if (!source_path.empty()) {
+		path_to_handle[source_path] = handle;
 	}
+	return handle;
 }
 
 Ks_Handle AssetManager_Impl::load_sync(const std::string& type_name, const std::string& asset_name, const std::string& file_path) {
@@ -316,7 +593,7 @@ Ks_Handle AssetManager_Impl::load_sync(const std::string& type_name, const std::
 	auto found_name = assets_name_to_handle.find(asset_name);
 	if (found_name != assets_name_to_handle.end()) {
 		Ks_Handle h = found_name->second;
-		assets_entries[h].ref_count++;
+		acquire_entry_nolock(*get_entry_nolock(h));
 		return h;
 	}
 
@@ -331,16 +608,11 @@ Ks_Handle AssetManager_Impl::load_sync(const std::string& type_name, const std::
 		return KS_INVALID_HANDLE;
 	}
 
-	Ks_Handle handle = generate_handle();
-	Ks_AssetEntry entry;
-	entry.data = asset_data;
-	entry.asset_name = asset_name;
-	entry.type_name = type_name;
-	entry.source_path = final_path;
-	entry.ref_count = 1;
-	entry.state = KS_ASSET_STATE_READY;
-
-	register_asset(handle, entry);
+	Ks_Handle handle = register_asset(type_name, asset_name, final_path, asset_data, KS_ASSET_STATE_READY);
+	if (handle == KS_INVALID_HANDLE) {
+		if (it_iface->second.destroy_fn) it_iface->second.destroy_fn(asset_data);
+		return KS_INVALID_HANDLE;
+	}
 	ks_file_watcher_watch_file(file_watcher, file_path.c_str(), on_asset_file_changed, this);
 
 	return handle;
@@ -357,7 +629,7 @@ Ks_Handle AssetManager_Impl::load_async(const std::string& type_name, const std:
 	auto found_name = assets_name_to_handle.find(asset_name);
 	if (found_name != assets_name_to_handle.end()) {
 		Ks_Handle h = found_name->second;
-		assets_entries[h].ref_count++;
+		acquire_entry_nolock(*get_entry_nolock(h));
 		return h;
 	}
 
@@ -366,16 +638,10 @@ Ks_Handle AssetManager_Impl::load_async(const std::string& type_name, const std:
 		return KS_INVALID_HANDLE;
 	}
 
-	Ks_Handle handle = generate_handle();
-	Ks_AssetEntry entry;
-	entry.data = nullptr;
-	entry.asset_name = asset_name;
-	entry.type_name = type_name;
-	entry.source_path = final_path;
-	entry.ref_count = 1;
-	entry.state = KS_ASSET_STATE_LOADING;
-
-	register_asset(handle, entry);
+	Ks_Handle handle = register_asset(type_name, asset_name, final_path, nullptr, KS_ASSET_STATE_LOADING);
+	if (handle == KS_INVALID_HANDLE) {
+		return KS_INVALID_HANDLE;
+	}
 
 	AsyncLoadPayload* payload = new(ks_alloc(sizeof(AsyncLoadPayload), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA)) AsyncLoadPayload();
 	payload->mgr = this;
@@ -407,7 +673,7 @@ Ks_Handle AssetManager_Impl::load_from_data(const std::string& type_name, const
 	auto found_name = assets_name_to_handle.find(asset_name);
 	if (found_name != assets_name_to_handle.end()) {
 		Ks_Handle h = found_name->second;
-		assets_entries[h].ref_count++;
+		acquire_entry_nolock(*get_entry_nolock(h));
 		return h;
 	}
 
@@ -423,16 +689,10 @@ Ks_Handle AssetManager_Impl::load_from_data(const std::string& type_name, const
 		return KS_INVALID_HANDLE;
 	}
 
-	Ks_Handle handle = generate_handle();
-	Ks_AssetEntry entry;
-	entry.data = asset_data;
-	entry.asset_name = asset_name;
-	entry.type_name = type_name;
-	entry.source_path = "";
-	entry.ref_count = 1;
-	entry.state = KS_ASSET_STATE_READY;
-	assets_entries.emplace(handle, entry);
-	assets_name_to_handle.emplace(asset_name, handle);
+	Ks_Handle handle = register_asset(type_name, asset_name, "", asset_data, KS_ASSET_STATE_READY);
+	if (handle == KS_INVALID_HANDLE && it_iface->second.destroy_fn) {
+		it_iface->second.destroy_fn(asset_data);
+	}
 
 	return handle;
 }
@@ -449,8 +709,8 @@ void AssetManager_Impl::complete_async_load(Ks_Handle handle, Ks_AssetData data,
 	}
 
 
-	auto it = assets_entries.find(handle);
-	if (it == assets_entries.end()) {
+	Ks_AssetEntry* found = get_entry_nolock(handle);
+	if (!found) {
 		if (success && data) {
 			ks_epush_s(KS_ERROR_LEVEL_WARNING, "AssetManager", AssetsError::RELEASE_DATA_ON_ASYNC_LOAD, "[Assets] Async load finished for released asset. Destroying data immediately.");
 			if (original_iface.destroy_fn) {
@@ -460,15 +720,15 @@ void AssetManager_Impl::complete_async_load(Ks_Handle handle, Ks_AssetData data,
 		return;
 	}
 
-	Ks_AssetEntry& entry = it->second;
+	Ks_AssetEntry& entry = *found;
 	if (success) {
-		entry.data = data;
-		entry.state = KS_ASSET_STATE_READY;
+		entry.data.store(data);
+		entry.state.store(KS_ASSET_STATE_READY);
 		ks_file_watcher_watch_file(file_watcher, entry.source_path.c_str(), on_asset_file_changed, this);
 		KS_LOG_INFO("[Assets] Async Load Ready: %s", entry.asset_name.c_str());
 	}
 	else {
-		entry.state = KS_ASSET_STATE_FAILED;
+		entry.state.store(KS_ASSET_STATE_FAILED);
 		ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "AssetManager", AssetsError::FAILED_ASYNC_LOAD,  "[Assets] Async Load Failed: %s", entry.asset_name.c_str());
 	}
 }
@@ -480,25 +740,26 @@ void AssetManager_Impl::update() {
 bool AssetManager_Impl::reload_asset(Ks_Handle handle) {
 	std::string type_name;
 	std::string source_path;
-	Ks_AssetData old_data = nullptr;
 
 	{
 		std::lock_guard<std::mutex> lock(assets_mutex);
-		auto found = assets_entries.find(handle);
-		if (found == assets_entries.end()) return false;
+		Ks_AssetEntry* found = get_entry_nolock(handle);
+		if (!found) return false;
 
-		Ks_AssetEntry& entry = found->second;
+		Ks_AssetEntry& entry = *found;
 		if (entry.source_path.empty()) return false;
 
 		type_name = entry.type_name;
 		source_path = entry.source_path;
-		old_data = entry.data;
 	}
 
 	Ks_IAsset iface;
+	asset_size_fn size_fn = nullptr;
 	{
 		std::lock_guard<std::mutex> lock(assets_mutex);
 		iface = get_asset_interface_nolock(type_name);
+		auto it = assets_size_fns.find(type_name);
+		if (it != assets_size_fns.end()) size_fn = it->second;
 	}
 
 	if (!iface.load_from_file_fn) return false;
@@ -508,17 +769,30 @@ bool AssetManager_Impl::reload_asset(Ks_Handle handle) {
 		return false;
 	}
 
+	// Measured before it is published, so the size function runs unlocked.
+	ks_size new_size = size_fn ? size_fn(new_data) : 0;
+
+	Ks_AssetData old_data = nullptr;
+	std::vector<AssetRemoval> removals;
 	{
 		std::lock_guard<std::mutex> lock(assets_mutex);
-		auto found = assets_entries.find(handle);
-		if (found == assets_entries.end()) {
+		Ks_AssetEntry* found = get_entry_nolock(handle);
+		if (!found) {
 			if (iface.destroy_fn) iface.destroy_fn(new_data);
 			return false;
 		}
 
-		found->second.data = new_data;
+		old_data = found->data.exchange(new_data);
+
+		if (found->cached && size_fn) {
+			cache_usage = cache_usage - found->cached_size + new_size;
+			found->cached_size = new_size;
+			evict_to_budget_nolock(removals);
+		}
 	}
 
+	finish_removals(removals);
+
 	if (old_data && iface.destroy_fn) {
 		iface.destroy_fn(old_data);
 	}
@@ -655,6 +929,24 @@ ks_no_ret ks_assets_manager_asset_release(Ks_AssetsManager am, Ks_Handle handle)
 	iam->release_asset(handle);
 }
 
+ks_bool ks_assets_manager_set_asset_size_fn(Ks_AssetsManager am, ks_str type_name, asset_size_fn size_fn)
+{
+	if (!am || !type_name) return false;
+	return static_cast<AssetManager_Impl*>(am)->set_size_fn(type_name, size_fn);
+}
+
+ks_no_ret ks_assets_manager_set_cache_budget(Ks_AssetsManager am, ks_size budget_bytes)
+{
+	if (!am) return;
+	static_cast<AssetManager_Impl*>(am)->set_cache_budget(budget_bytes);
+}
+
+ks_size ks_assets_manager_get_cache_usage(Ks_AssetsManager am)
+{
+	if (!am) return 0;
+	return static_cast<AssetManager_Impl*>(am)->get_cache_usage();
+}
+
 ks_bool ks_assets_is_handle_valid(Ks_AssetsManager am, Ks_Handle handle)
 {
 	if (handle == KS_INVALID_HANDLE) return false;
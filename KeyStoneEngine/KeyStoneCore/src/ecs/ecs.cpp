@@ -3,11 +3,21 @@
 #include "../include/core/log.h"
 #include "../include/core/error.h"
 #include "../include/memory/memory.h"
+#include "../include/profiler/profiler.h"
 
 #include <flecs.h>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include <string.h>
 
 extern "C" {
@@ -22,19 +32,205 @@ extern "C" {
 
 enum ECSErros {
     SYSTEM_CREATION_FAIL,
-    QUERY_CREATION_FAIL
+    QUERY_CREATION_FAIL,
+    BULK_CREATION_FAIL,
+    SNAPSHOT_LOAD_FAIL,
+    TASK_BINDING_FAIL,
+    COMMAND_BUFFER_FAIL
+};
+
+struct EcsTaskPayload {
+    ecs_os_thread_callback_t callback;
+    void* param;
+};
+
+#ifdef EcsQueryDetectChanges
+static constexpr ecs_flags32_t KS_QUERY_DETECT_CHANGES = EcsQueryDetectChanges;
+#else
+// Older flecs builds enable change detection lazily on the first
+// ecs_query_changed / ecs_iter_changed call.
+static constexpr ecs_flags32_t KS_QUERY_DETECT_CHANGES = 0;
+#endif
+
+// The flecs task hooks are process wide and carry no world, so every world
+// that runs its workers as jobs has to share one job manager. The hooks are
+// restored once the last of those worlds is destroyed or unbound.
+static std::mutex s_task_mutex;
+static Ks_JobManager s_task_jobs = nullptr;
+static ks_uint32 s_task_worlds = 0;
+static ecs_os_api_thread_new_t s_prev_task_new = nullptr;
+static ecs_os_api_thread_join_t s_prev_task_join = nullptr;
+
+static void ecs_task_job(Ks_Payload payload) {
+    EcsTaskPayload* task = (EcsTaskPayload*)payload.data;
+    task->callback(task->param);
+}
+
+static ecs_os_thread_t ecs_task_new(ecs_os_thread_callback_t callback, void* param) {
+    EcsTaskPayload task = { callback, param };
+    Ks_JobCounter counter = ks_job_run(s_task_jobs, ecs_task_job, &task, sizeof(task), ks_true, nullptr);
+    return (ecs_os_thread_t)counter;
+}
+
+static void* ecs_task_join(ecs_os_thread_t thread) {
+    ks_job_wait(s_task_jobs, (Ks_JobCounter)thread);
+    return nullptr;
+}
+
+struct Ks_Ecs_Query_Impl;
+
+enum EcsCmdKind {
+    ECS_CMD_CREATE,
+    ECS_CMD_DESTROY,
+    ECS_CMD_SET,
+    ECS_CMD_REMOVE
+};
+
+struct EcsCmd {
+    ks_uint64 key;
+    EcsCmdKind kind;
+    ecs_entity_t entity;
+    ecs_id_t component;
+    ks_size offset;
+    ks_size size;
+};
+
+// Entities created through a command buffer get a placeholder id until the
+// flush assigns a real one: tag bit | buffer slot | index in that buffer.
+static constexpr ks_uint64 KS_ECS_CMD_PENDING = 1ull << 60;
+
+struct EcsCmdBuffer {
+    ks_uint32 slot;
+    ks_uint32 pending_creates;
+    std::vector<EcsCmd> cmds;
+    std::vector<ks_byte> data;
+    std::vector<ecs_entity_t> created;
+};
+
+// Which buffer a flush reads a command from; sorted by (key, slot, index).
+struct EcsCmdRef {
+    ks_uint64 key;
+    ks_uint32 slot;
+    ks_uint32 index;
+};
+
+struct EcsSnapshotHook {
+    Ks_Ecs_Snapshot_Save_Func save;
+    Ks_Ecs_Snapshot_Load_Func load;
+    Ks_Ecs_Snapshot_Discard_Func discard;
+    void* user_data;
+};
+
+// Per-frame counters are written from the system callbacks, possibly on
+// several workers for multi threaded systems, and folded into the totals
+// by ks_ecs_progress once the frame is done.
+struct EcsSystemStats {
+    ecs_entity_t system;
+    std::string name;
+    std::atomic<ks_int64> frame_start_ns{ INT64_MAX };
+    std::atomic<ks_int64> frame_end_ns{ 0 };
+    std::atomic<ks_int32> frame_tables{ 0 };
+    std::atomic<ks_int32> frame_entities{ 0 };
+
+    ks_uint64 invocations = 0;
+    ks_int32 last_tables = 0;
+    ks_int32 last_entities = 0;
+    ks_int64 last_ns = 0;
+    ks_int64 max_ns = 0;
+    ks_int64 total_ns = 0;
+};
+
+// Extraction is double buffered: readers pin the front frame while the next
+// extraction fills the other one. When a reader still holds the other frame
+// from two extractions ago, the extraction is skipped rather than waiting, so
+// a slow reader never stalls the simulation.
+struct EcsExtractColumn {
+    ecs_id_t id = 0;
+    std::string name;
+    ks_size size = 0;
+    std::vector<ecs_entity_t> entities;
+    std::vector<ks_byte> data;
+};
+
+struct EcsExtractState;
+
+struct EcsExtractFrame {
+    EcsExtractState* state = nullptr;
+    ks_uint64 index = 0;
+    ks_int32 readers = 0;
+    std::vector<EcsExtractColumn> columns;
+};
+
+struct EcsExtractState {
+    std::vector<std::pair<std::string, ecs_id_t>> components;
+    bool auto_extract = true;
+
+    std::mutex mutex;
+    EcsExtractFrame frames[2];
+    ks_int32 front = -1;
+    ks_uint64 counter = 0;
+
+    EcsExtractState() {
+        frames[0].state = this;
+        frames[1].state = this;
+    }
+};
+
+static std::atomic<ks_uint64> s_world_serial{ 0 };
+
+struct EcsCmdCache {
+    ks_uint64 world_serial;
+    EcsCmdBuffer* buffer;
+};
+
+static thread_local EcsCmdCache s_cmd_cache = { 0, nullptr };
+
+// Replay order of the commands this thread records. System trampolines set it
+// per chunk, so the order no longer depends on which worker ran the chunk.
+static thread_local ks_uint64 s_cmd_sort_key = 0;
+
+struct EcsDestroyHook {
+    Ks_Ecs_Destroy_Func func;
+    void* user_data;
 };
 
 struct Ks_Ecs_World_Impl {
     ecs_world_t* ecs;
+    ks_uint64 serial;
+    bool task_bound = false;
+    std::vector<EcsDestroyHook> destroy_hooks;
     std::unordered_map<std::string, ecs_entity_t> component_ids;
     std::unordered_map<ecs_entity_t, const Ks_Type_Info*> ids_to_type_info;
+    std::unordered_set<Ks_Ecs_Query_Impl*> queries;
+    std::unordered_map<ecs_id_t, EcsSnapshotHook> snapshot_hooks;
+    std::unordered_map<ecs_entity_t, EcsSystemStats*> system_stats;
+    EcsExtractState extract;
+
+    std::mutex cmd_mutex;
+    std::vector<EcsCmdBuffer*> cmd_buffers;
+    std::unordered_map<std::thread::id, EcsCmdBuffer*> cmd_buffer_by_thread;
+    std::vector<EcsCmdRef> cmd_order;
+
+    // Filled when components are registered, so command buffers on worker
+    // threads never query flecs for type info mid-frame.
+    std::shared_mutex size_mutex;
+    std::unordered_map<ecs_id_t, ks_size> component_sizes;
 
     ~Ks_Ecs_World_Impl() {
         if (ecs) ecs_fini(ecs);
+        for (auto* q : queries) ks_dealloc(q);
+        for (auto* b : cmd_buffers) {
+            b->~EcsCmdBuffer();
+            ks_dealloc(b);
+        }
     }
 };
 
+struct Ks_Ecs_Query_Impl {
+    Ks_Ecs_World world;
+    ecs_query_t* query;
+};
+
 Ks_Ecs_World_Impl* get(Ks_Ecs_World world) {
     return static_cast<Ks_Ecs_World_Impl*>(world);
 }
@@ -67,6 +263,10 @@ static ecs_entity_t get_component_id(Ks_Ecs_World world, const char* type_name)
 
     w->component_ids[type_name] = id;
     w->ids_to_type_info[id] = info;
+    {
+        std::unique_lock<std::shared_mutex> lock(w->size_mutex);
+        w->component_sizes[id] = (ks_size)component_desc.type.size;
+    }
 
     return id;
 }
@@ -75,19 +275,223 @@ Ks_Ecs_World ks_ecs_create_world() {
     void* mem = ks_alloc_debug(sizeof(Ks_Ecs_World_Impl), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEcsWorld");
     Ks_Ecs_World_Impl* w = new(mem) Ks_Ecs_World_Impl();
     w->ecs = ecs_init();
+    w->serial = ++s_world_serial;
     return w;
 }
 
+static void release_task_hooks() {
+    std::lock_guard<std::mutex> lock(s_task_mutex);
+    if (s_task_worlds == 0 || --s_task_worlds > 0) return;
+
+    ecs_os_api.task_new_ = s_prev_task_new;
+    ecs_os_api.task_join_ = s_prev_task_join;
+    s_task_jobs = nullptr;
+}
+
 void ks_ecs_destroy_world(Ks_Ecs_World world) {
     if (world) {
         auto w = get(world);
+
+        // Hooks run newest first while the flecs world is still intact, so
+        // they can release queries and observers they created on it.
+        std::vector<EcsDestroyHook> hooks;
+        hooks.swap(w->destroy_hooks);
+        for (auto it = hooks.rbegin(); it != hooks.rend(); ++it) {
+            it->func(world, it->user_data);
+        }
+
+        // flecs joins its workers inside ecs_fini, so the task hooks have
+        // to stay installed until the world is gone.
+        bool task_bound = w->task_bound;
         w->~Ks_Ecs_World_Impl();
         ks_dealloc(w);
+        if (task_bound) release_task_hooks();
     }
 }
 
+static EcsCmdBuffer* get_cmd_buffer(Ks_Ecs_World_Impl* w) {
+    if (s_cmd_cache.world_serial == w->serial) return s_cmd_cache.buffer;
+
+    std::lock_guard<std::mutex> lock(w->cmd_mutex);
+    EcsCmdBuffer*& buffer = w->cmd_buffer_by_thread[std::this_thread::get_id()];
+    if (!buffer) {
+        void* mem = ks_alloc_debug(sizeof(EcsCmdBuffer), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEcsCmdBuffer");
+        buffer = new(mem) EcsCmdBuffer();
+        buffer->slot = (ks_uint32)w->cmd_buffers.size();
+        buffer->pending_creates = 0;
+        w->cmd_buffers.push_back(buffer);
+    }
+
+    s_cmd_cache = { w->serial, buffer };
+    return buffer;
+}
+
+static ecs_entity_t resolve_cmd_entity(Ks_Ecs_World_Impl* w, ecs_entity_t entity) {
+    if (!(entity & KS_ECS_CMD_PENDING)) return entity;
+
+    ks_uint32 slot = (ks_uint32)((entity & ~KS_ECS_CMD_PENDING) >> 32);
+    ks_uint32 index = (ks_uint32)(entity & 0xFFFFFFFF);
+    if (slot >= w->cmd_buffers.size() || index >= w->cmd_buffers[slot]->created.size()) return 0;
+    return w->cmd_buffers[slot]->created[index];
+}
+
+static void flush_commands(Ks_Ecs_World_Impl* w) {
+    std::lock_guard<std::mutex> lock(w->cmd_mutex);
+
+    bool has_work = false;
+    for (auto* b : w->cmd_buffers) {
+        if (b->pending_creates || !b->cmds.empty()) { has_work = true; break; }
+    }
+    if (!has_work) return;
+
+    // Replay by sort key rather than by buffer: which worker thread ended up
+    // recording a chunk must not change the result. Ties only happen between
+    // threads recording without a key, and fall back to buffer slot order.
+    w->cmd_order.clear();
+    for (auto* b : w->cmd_buffers) {
+        for (ks_uint32 i = 0; i < (ks_uint32)b->cmds.size(); ++i) {
+            w->cmd_order.push_back({ b->cmds[i].key, b->slot, i });
+        }
+    }
+    std::sort(w->cmd_order.begin(), w->cmd_order.end(), [](const EcsCmdRef& a, const EcsCmdRef& b) {
+        if (a.key != b.key) return a.key < b.key;
+        if (a.slot != b.slot) return a.slot < b.slot;
+        return a.index < b.index;
+    });
+
+    ecs_defer_begin(w->ecs);
+
+    // Creates are resolved first so commands may reference entities created
+    // by any buffer.
+    for (auto* b : w->cmd_buffers) {
+        b->created.assign(b->pending_creates, 0);
+    }
+    for (const EcsCmdRef& ref : w->cmd_order) {
+        EcsCmdBuffer* b = w->cmd_buffers[ref.slot];
+        const EcsCmd& cmd = b->cmds[ref.index];
+        if (cmd.kind != ECS_CMD_CREATE) continue;
+        b->created[(ks_uint32)(cmd.entity & 0xFFFFFFFF)] = ecs_new(w->ecs);
+    }
+
+    for (const EcsCmdRef& ref : w->cmd_order) {
+        EcsCmdBuffer* b = w->cmd_buffers[ref.slot];
+        const EcsCmd& cmd = b->cmds[ref.index];
+        if (cmd.kind == ECS_CMD_CREATE) continue;
+
+        ecs_entity_t e = resolve_cmd_entity(w, cmd.entity);
+        if (!e) continue;
+
+        switch (cmd.kind) {
+        case ECS_CMD_DESTROY:
+            ecs_delete(w->ecs, e);
+            break;
+        case ECS_CMD_SET:
+            ecs_set_id(w->ecs, e, cmd.component, cmd.size, b->data.data() + cmd.offset);
+            break;
+        case ECS_CMD_REMOVE:
+            ecs_remove_id(w->ecs, e, cmd.component);
+            break;
+        default:
+            break;
+        }
+    }
+
+    ecs_defer_end(w->ecs);
+
+    for (auto* b : w->cmd_buffers) {
+        b->cmds.clear();
+        b->data.clear();
+        b->created.clear();
+        b->pending_creates = 0;
+    }
+}
+
+static void roll_system_stats(Ks_Ecs_World_Impl* w) {
+    for (auto& [sys, stats] : w->system_stats) {
+        ks_int32 tables = stats->frame_tables.exchange(0, std::memory_order_relaxed);
+        ks_int64 start = stats->frame_start_ns.exchange(INT64_MAX, std::memory_order_relaxed);
+        ks_int64 end = stats->frame_end_ns.exchange(0, std::memory_order_relaxed);
+
+        stats->last_tables = tables;
+        stats->last_entities = stats->frame_entities.exchange(0, std::memory_order_relaxed);
+        stats->last_ns = tables > 0 ? end - start : 0;
+        if (tables == 0) continue;
+
+        stats->invocations++;
+        stats->total_ns += stats->last_ns;
+        if (stats->last_ns > stats->max_ns) stats->max_ns = stats->last_ns;
+    }
+}
+
+static bool run_extraction(Ks_Ecs_World_Impl* w);
+
+void ks_ecs_on_destroy(Ks_Ecs_World world, Ks_Ecs_Destroy_Func func, void* user_data) {
+    if (!world || !func) return;
+    auto w = get(world);
+    for (const EcsDestroyHook& hook : w->destroy_hooks) {
+        if (hook.func == func && hook.user_data == user_data) return;
+    }
+    w->destroy_hooks.push_back({ func, user_data });
+}
+
+void ks_ecs_remove_on_destroy(Ks_Ecs_World world, Ks_Ecs_Destroy_Func func, void* user_data) {
+    if (!world || !func) return;
+    auto& hooks = get(world)->destroy_hooks;
+    hooks.erase(std::remove_if(hooks.begin(), hooks.end(), [&](const EcsDestroyHook& hook) {
+        return hook.func == func && hook.user_data == user_data;
+    }), hooks.end());
+}
+
 void ks_ecs_progress(Ks_Ecs_World world, float delta_time) {
-    if (world) ecs_progress(get(world)->ecs, delta_time);
+    if (!world) return;
+    auto w = get(world);
+    flush_commands(w);
+    ecs_progress(w->ecs, delta_time);
+    roll_system_stats(w);
+    if (w->extract.auto_extract) run_extraction(w);
+}
+
+void ks_ecs_set_threads(Ks_Ecs_World world, Ks_JobManager jobs, ks_uint32 worker_count) {
+    if (!world) return;
+    auto w = get(world);
+
+    if (!jobs) {
+        ecs_set_threads(w->ecs, (int32_t)worker_count + 1);
+        if (w->task_bound) {
+            w->task_bound = false;
+            release_task_hooks();
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_task_mutex);
+        if (s_task_jobs && s_task_jobs != jobs) {
+            ks_epush_s(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::TASK_BINDING_FAIL, "ECS worlds already run their workers on another job manager");
+            return;
+        }
+        if (s_task_worlds == 0) {
+            s_prev_task_new = ecs_os_api.task_new_;
+            s_prev_task_join = ecs_os_api.task_join_;
+            s_task_jobs = jobs;
+            ecs_os_api.task_new_ = ecs_task_new;
+            ecs_os_api.task_join_ = ecs_task_join;
+        }
+        if (!w->task_bound) {
+            w->task_bound = true;
+            ++s_task_worlds;
+        }
+    }
+
+    // Each flecs worker blocks on the pipeline sync points, so every task must
+    // own a pool thread or the frame would wait on a job that never starts.
+    // One pool thread stays free for the jobs the workers wait on, and the
+    // thread calling ks_ecs_progress must not be a pool thread itself.
+    ks_uint32 pool_threads = ks_job_system_get_thread_count(jobs);
+    ks_uint32 max_workers = pool_threads > 0 ? pool_threads - 1 : 0;
+    if (worker_count == 0 || worker_count > max_workers) worker_count = max_workers;
+
+    ecs_set_task_threads(w->ecs, (int32_t)worker_count + 1);
 }
 
 Ks_Entity ks_ecs_create_entity(Ks_Ecs_World world, const char* name) {
@@ -100,6 +504,40 @@ void ks_ecs_destroy_entity(Ks_Ecs_World world, Ks_Entity entity) {
     ecs_delete(get(world)->ecs, (ecs_entity_t)entity);
 }
 
+Ks_Entity_Range ks_ecs_create_entities(Ks_Ecs_World world, ks_int32 count, const Ks_Component* components, ks_int32 component_count, const void* const* data_columns) {
+    Ks_Entity_Range range = { nullptr, 0 };
+    if (!world || count <= 0) return range;
+
+    if (component_count < 0 || component_count >= FLECS_ID_DESC_MAX) {
+        ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::BULK_CREATION_FAIL, "Bulk creation supports up to %d components, got %d", FLECS_ID_DESC_MAX - 1, component_count);
+        return range;
+    }
+    if (component_count > 0 && !components) {
+        ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::BULK_CREATION_FAIL, "Bulk creation got %d components but no component ids", component_count);
+        return range;
+    }
+
+    ecs_bulk_desc_t desc = { 0 };
+    void* columns[FLECS_ID_DESC_MAX] = { 0 };
+
+    desc.count = count;
+    for (ks_int32 i = 0; i < component_count; ++i) {
+        desc.ids[i] = (ecs_id_t)components[i];
+        columns[i] = data_columns ? (void*)data_columns[i] : nullptr;
+    }
+    desc.data = data_columns ? columns : nullptr;
+
+    const ecs_entity_t* entities = ecs_bulk_init(get(world)->ecs, &desc);
+    if (!entities) {
+        ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::BULK_CREATION_FAIL, "Failed to bulk create %d entities", count);
+        return range;
+    }
+
+    range.entities = (const Ks_Entity*)entities;
+    range.count = count;
+    return range;
+}
+
 void ks_ecs_enable_entity(Ks_Ecs_World world, Ks_Entity entity, bool enabled){
     ecs_enable(get(world)->ecs, (ecs_entity_t)entity, enabled);
 }
@@ -116,39 +554,133 @@ Ks_Entity ks_ecs_lookup(Ks_Ecs_World world, const char* name){
     return (Ks_Entity)ecs_lookup(get(world)->ecs, name);
 }
 
-void ks_ecs_set_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name, const void* data) {
-    ecs_entity_t id = get_component_id(world, type_name);
-    const Ks_Type_Info* info = get(world)->ids_to_type_info[id];
-    size_t size = info ? info->size : sizeof(ks_int);
+Ks_Entity ks_ecs_cmd_create(Ks_Ecs_World world) {
+    if (!world) return 0;
+    EcsCmdBuffer* b = get_cmd_buffer(get(world));
+    ecs_entity_t pending = KS_ECS_CMD_PENDING | ((ks_uint64)b->slot << 32) | b->pending_creates++;
+    b->cmds.push_back({ s_cmd_sort_key, ECS_CMD_CREATE, pending, 0, 0, 0 });
+    return (Ks_Entity)pending;
+}
+
+void ks_ecs_cmd_destroy(Ks_Ecs_World world, Ks_Entity entity) {
+    if (!world || !entity) return;
+    EcsCmdBuffer* b = get_cmd_buffer(get(world));
+    b->cmds.push_back({ s_cmd_sort_key, ECS_CMD_DESTROY, (ecs_entity_t)entity, 0, 0, 0 });
+}
+
+void ks_ecs_cmd_set(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component, const void* data) {
+    if (!world || !entity || !component) return;
+    auto w = get(world);
+    EcsCmdBuffer* b = get_cmd_buffer(w);
+
+    ks_size size = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(w->size_mutex);
+        auto it = w->component_sizes.find((ecs_id_t)component);
+        if (it == w->component_sizes.end()) {
+            ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::COMMAND_BUFFER_FAIL, "Deferred set of unregistered component %llu", (unsigned long long)component);
+            return;
+        }
+        size = it->second;
+    }
+
+    ks_size offset = b->data.size();
+    b->data.resize(offset + size);
+    if (data) memcpy(b->data.data() + offset, data, size);
 
-    ecs_set_id(get(world)->ecs, (ecs_entity_t)entity, id, size, data);
+    b->cmds.push_back({ s_cmd_sort_key, ECS_CMD_SET, (ecs_entity_t)entity, (ecs_id_t)component, offset, size });
+}
+
+void ks_ecs_cmd_remove(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component) {
+    if (!world || !entity || !component) return;
+    EcsCmdBuffer* b = get_cmd_buffer(get(world));
+    b->cmds.push_back({ s_cmd_sort_key, ECS_CMD_REMOVE, (ecs_entity_t)entity, (ecs_id_t)component, 0, 0 });
+}
+
+void ks_ecs_cmd_set_sort_key(ks_uint64 key) {
+    s_cmd_sort_key = key;
+}
+
+void ks_ecs_cmd_flush(Ks_Ecs_World world) {
+    if (world) flush_commands(get(world));
+}
+
+void ks_ecs_set_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name, const void* data) {
+    ks_ecs_set_component_by_id(world, entity, get_component_id(world, type_name), data);
 }
 
 const void* ks_ecs_get_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name) {
-    ecs_entity_t id = get_component_id(world, type_name);
-    return ecs_get_id(get(world)->ecs, (ecs_entity_t)entity, id);
+    return ks_ecs_get_component_by_id(world, entity, get_component_id(world, type_name));
 }
 
 void* ks_ecs_get_component_mut(Ks_Ecs_World world, Ks_Entity entity, const char* type_name) {
-    ecs_entity_t id = get_component_id(world, type_name);
-    return ecs_get_mut_id(get(world)->ecs, (ecs_entity_t)entity, id);
+    return ks_ecs_get_component_mut_by_id(world, entity, get_component_id(world, type_name));
 }
 
 void ks_ecs_remove_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name) {
     auto w = get(world);
     auto it = w->component_ids.find(type_name);
     if (it != w->component_ids.end()) {
-        ecs_remove_id(w->ecs, (ecs_entity_t)entity, it->second);
+        ks_ecs_remove_component_by_id(world, entity, it->second);
     }
 }
 
 bool ks_ecs_has_component(Ks_Ecs_World world, Ks_Entity entity, const char* type_name) {
-    ecs_entity_t id = get_component_id(world, type_name);
-    if (!id) return false;
-    const void* ptr = ecs_get_id(get(world)->ecs, (ecs_entity_t)entity, id);
+    return ks_ecs_has_component_by_id(world, entity, get_component_id(world, type_name));
+}
+
+void ks_ecs_modified(Ks_Ecs_World world, Ks_Entity entity, const char* type_name) {
+    ks_ecs_modified_by_id(world, entity, get_component_id(world, type_name));
+}
+
+Ks_Component ks_ecs_component_id(Ks_Ecs_World world, const char* type_name) {
+    if (!world || !type_name) return 0;
+    return (Ks_Component)get_component_id(world, type_name);
+}
+
+ks_size ks_ecs_component_size(Ks_Ecs_World world, Ks_Component component) {
+    if (!world || !component) return 0;
+    auto w = get(world);
+    std::shared_lock<std::shared_mutex> lock(w->size_mutex);
+    auto it = w->component_sizes.find((ecs_id_t)component);
+    return it != w->component_sizes.end() ? it->second : 0;
+}
+
+void ks_ecs_set_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component, const void* data) {
+    if (!world || !component) return;
+    auto w = get(world);
+    const ecs_type_info_t* ti = ecs_get_type_info(w->ecs, (ecs_id_t)component);
+    size_t size = ti ? (size_t)ti->size : sizeof(ks_int);
+
+    ecs_set_id(w->ecs, (ecs_entity_t)entity, (ecs_id_t)component, size, data);
+}
+
+const void* ks_ecs_get_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component) {
+    if (!world || !component) return nullptr;
+    return ecs_get_id(get(world)->ecs, (ecs_entity_t)entity, (ecs_id_t)component);
+}
+
+void* ks_ecs_get_component_mut_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component) {
+    if (!world || !component) return nullptr;
+    return ecs_get_mut_id(get(world)->ecs, (ecs_entity_t)entity, (ecs_id_t)component);
+}
+
+void ks_ecs_remove_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component) {
+    if (!world || !component) return;
+    ecs_remove_id(get(world)->ecs, (ecs_entity_t)entity, (ecs_id_t)component);
+}
+
+bool ks_ecs_has_component_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component) {
+    if (!world || !component) return false;
+    const void* ptr = ecs_get_id(get(world)->ecs, (ecs_entity_t)entity, (ecs_id_t)component);
     return ptr != nullptr;
 }
 
+void ks_ecs_modified_by_id(Ks_Ecs_World world, Ks_Entity entity, Ks_Component component) {
+    if (!world || !component) return;
+    ecs_modified_id(get(world)->ecs, (ecs_entity_t)entity, (ecs_id_t)component);
+}
+
 void ks_ecs_add_child(Ks_Ecs_World world, Ks_Entity parent, Ks_Entity child) {
     ecs_add_pair(get(world)->ecs, (ecs_entity_t)child, EcsChildOf, (ecs_entity_t)parent);
 }
@@ -183,6 +715,38 @@ Ks_Entity ks_ecs_instantiate(Ks_Ecs_World world, Ks_Entity prefab) {
     return (Ks_Entity)ecs_new_w_id(w->ecs, relation_pair);
 }
 
+Ks_Entity_Range ks_ecs_instantiate_n(Ks_Ecs_World world, Ks_Entity prefab, ks_int32 count, Ks_Entity* out_entities) {
+    Ks_Entity_Range range = { nullptr, 0 };
+    if (!world || !prefab || count <= 0) return range;
+
+    // A single table move for the whole batch: flecs copies the overridden
+    // components and instantiates prefab children for every new entity.
+    ecs_bulk_desc_t desc = { 0 };
+    desc.count = count;
+    desc.ids[0] = ecs_pair(EcsIsA, (ecs_entity_t)prefab);
+
+    const ecs_entity_t* entities = ecs_bulk_init(get(world)->ecs, &desc);
+    if (!entities) {
+        ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::BULK_CREATION_FAIL, "Failed to instantiate %d entities from prefab", count);
+        return range;
+    }
+
+    if (out_entities) {
+        memcpy(out_entities, entities, sizeof(Ks_Entity) * (ks_size)count);
+        range.entities = out_entities;
+    }
+    else {
+        range.entities = (const Ks_Entity*)entities;
+    }
+    range.count = count;
+    return range;
+}
+
+bool ks_ecs_is_prefab(Ks_Ecs_World world, Ks_Entity entity) {
+    if (!world || !entity) return false;
+    return ecs_has_id(get(world)->ecs, (ecs_entity_t)entity, EcsPrefab);
+}
+
 void ks_ecs_set_global(Ks_Ecs_World world, const char* type_name, const void* data) {
     ecs_entity_t id = get_component_id(world, type_name);
 
@@ -200,27 +764,143 @@ void* ks_ecs_get_global(Ks_Ecs_World world, const char* type_name) {
     return ecs_get_mut_id(get(world)->ecs, id, id);
 }
 
-struct SysCtx { Ks_System_Func cb; void* ud; Ks_Ecs_World w; };
+struct SysCtx { Ks_System_Func cb; void* ud; Ks_Ecs_World w; EcsSystemStats* stats = nullptr; };
+struct IterSysCtx { Ks_System_Iter_Func cb; void* ud; Ks_Ecs_World w; EcsSystemStats* stats = nullptr; };
+
+static_assert(sizeof(Ks_Entity) == sizeof(ecs_entity_t), "Ks_Entity must match ecs_entity_t");
+
+static ks_int64 stats_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Times one table worth of a system callback. Observers and ad-hoc queries
+// share the trampolines but carry no stats, which makes this a no-op.
+class SystemStatsScope {
+public:
+    SystemStatsScope(EcsSystemStats* stats, ks_int32 count)
+        : m_Stats(stats), m_Count(count), m_Start(stats ? stats_now_ns() : 0) {}
+
+    ~SystemStatsScope() {
+        if (!m_Stats) return;
+        ks_int64 end = stats_now_ns();
+
+        ks_int64 prev = m_Stats->frame_start_ns.load(std::memory_order_relaxed);
+        while (m_Start < prev && !m_Stats->frame_start_ns.compare_exchange_weak(prev, m_Start, std::memory_order_relaxed)) {}
+        prev = m_Stats->frame_end_ns.load(std::memory_order_relaxed);
+        while (end > prev && !m_Stats->frame_end_ns.compare_exchange_weak(prev, end, std::memory_order_relaxed)) {}
+
+        m_Stats->frame_tables.fetch_add(1, std::memory_order_relaxed);
+        m_Stats->frame_entities.fetch_add(m_Count, std::memory_order_relaxed);
+    }
+
+private:
+    EcsSystemStats* m_Stats;
+    ks_int32 m_Count;
+    ks_int64 m_Start;
+};
+
+static const char* stats_name(const EcsSystemStats* stats) {
+    return stats ? stats->name.c_str() : "EcsObserver";
+}
+
+// Keys the commands a chunk records by (system, first entity of the chunk),
+// which is the same every run no matter which thread picks the chunk up.
+class CmdSortKeyScope {
+public:
+    explicit CmdSortKeyScope(const ecs_iter_t* it) : m_Prev(s_cmd_sort_key) {
+        ks_uint64 first = it->count > 0 ? (ks_uint32)it->entities[0] : 0;
+        s_cmd_sort_key = ((ks_uint64)(ks_uint32)it->system << 32) | first;
+    }
+
+    ~CmdSortKeyScope() { s_cmd_sort_key = m_Prev; }
+
+private:
+    ks_uint64 m_Prev;
+};
 
 static void sys_trampoline(ecs_iter_t* it) {
     SysCtx* ctx = (SysCtx*)it->ctx;
+    KS_PROFILE_SCOPE(stats_name(ctx->stats));
+    SystemStatsScope scope(ctx->stats, it->count);
+    CmdSortKeyScope key(it);
     for (int i = 0; i < it->count; ++i) {
         ctx->cb(ctx->w, (Ks_Entity)it->entities[i], ctx->ud);
     }
 }
 
-void ks_ecs_create_system(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Func func, void* user_data) {
+static void dispatch_iter(ecs_iter_t* it, const IterSysCtx* ctx) {
+    Ks_Ecs_Iter kit;
+    kit.world = ctx->w;
+    kit.count = it->count;
+    kit.entities = (const Ks_Entity*)it->entities;
+    kit.field_count = it->field_count;
+    kit.delta_time = it->delta_time;
+    kit.user_data = ctx->ud;
+    kit._impl = it;
+    ctx->cb(&kit);
+}
+
+static void sys_iter_trampoline(ecs_iter_t* it) {
+    IterSysCtx* ctx = (IterSysCtx*)it->ctx;
+    KS_PROFILE_SCOPE(stats_name(ctx->stats));
+    SystemStatsScope scope(ctx->stats, it->count);
+    CmdSortKeyScope key(it);
+    dispatch_iter(it, ctx);
+}
+
+static void sys_changed_trampoline(ecs_iter_t* it) {
+    if (!ecs_iter_changed(it)) {
+        ecs_iter_skip(it);
+        return;
+    }
+    sys_iter_trampoline(it);
+}
+
+static EcsSystemStats* track_system(Ks_Ecs_World world, ecs_entity_t sys) {
+    auto w = get(world);
+    void* mem = ks_alloc_debug(sizeof(EcsSystemStats), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEcsSystemStats");
+    EcsSystemStats* stats = new(mem) EcsSystemStats();
+    stats->system = sys;
+
+    const char* name = ecs_get_name(w->ecs, sys);
+    stats->name = name ? name : "EcsSystem#" + std::to_string((ks_uint32)sys);
+
+    w->system_stats[sys] = stats;
+    return stats;
+}
+
+static void untrack_system(Ks_Ecs_World world, EcsSystemStats* stats) {
+    if (!stats) return;
+    get(world)->system_stats.erase(stats->system);
+    stats->~EcsSystemStats();
+    ks_dealloc(stats);
+}
+
+static void iter_ctx_free(void* ctx) {
+    IterSysCtx* c = (IterSysCtx*)ctx;
+    untrack_system(c->w, c->stats);
+    delete c;
+}
+
+static void sys_ctx_free(void* ctx) {
+    SysCtx* c = (SysCtx*)ctx;
+    untrack_system(c->w, c->stats);
+    delete c;
+}
+
+static ecs_entity_t init_system(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, ecs_iter_action_t callback, void* ctx, ecs_ctx_free_t ctx_free, bool multi_threaded, ecs_flags32_t query_flags = 0) {
     auto w = get(world);
-    SysCtx* ctx = new SysCtx{ func, user_data, world };
 
     ecs_system_desc_t sys_desc = { 0 };
     ecs_entity_desc_t ent_desc = { 0 };
     ent_desc.name = name;
-    sys_desc.entity = ecs_entity_init(w->ecs, &ent_desc);;
+    sys_desc.entity = ecs_entity_init(w->ecs, &ent_desc);
     sys_desc.query.expr = filter;
-    sys_desc.query.flags = EcsQueryAllowUnresolvedByName;
-    sys_desc.callback = sys_trampoline;
+    sys_desc.query.flags = EcsQueryAllowUnresolvedByName | query_flags;
+    sys_desc.callback = callback;
     sys_desc.ctx = ctx;
+    sys_desc.ctx_free = ctx_free;
+    sys_desc.multi_threaded = multi_threaded;
 
     ecs_entity_t sys_entity = ecs_system_init(w->ecs, &sys_desc);
 
@@ -236,19 +916,34 @@ void ks_ecs_create_system(Ks_Ecs_World world, const char* name, const char* filt
     else {
         ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::SYSTEM_CREATION_FAIL, "Failed to create system '%s'", name);
     }
+
+    return sys_entity;
 }
 
-void ks_ecs_run_query(Ks_Ecs_World world, const char* filter, Ks_System_Func func, void* user_data){
-    auto w = get(world);
+static ecs_query_t* init_query(Ks_Ecs_World world, const char* filter, ecs_query_cache_kind_t cache_kind, ecs_flags32_t flags = 0) {
     ecs_query_desc_t desc = { 0 };
     desc.expr = filter;
-    desc.flags = EcsQueryAllowUnresolvedByName;
+    desc.flags = EcsQueryAllowUnresolvedByName | flags;
+    desc.cache_kind = cache_kind;
 
-    ecs_query_t* q = ecs_query_init(w->ecs, &desc);
+    ecs_query_t* q = ecs_query_init(get(world)->ecs, &desc);
     if (!q) {
         ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::QUERY_CREATION_FAIL, "Failed to create query for filter '%s'", filter);
-        return;
     }
+    return q;
+}
+
+void ks_ecs_create_system(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Func func, void* user_data) {
+    SysCtx* ctx = new SysCtx{ func, user_data, world };
+    ecs_entity_t sys = init_system(world, name, filter, phase_id, sys_trampoline, ctx, sys_ctx_free, false);
+    if (!sys) delete ctx;
+    else ctx->stats = track_system(world, sys);
+}
+
+void ks_ecs_run_query(Ks_Ecs_World world, const char* filter, Ks_System_Func func, void* user_data){
+    auto w = get(world);
+    ecs_query_t* q = init_query(world, filter, EcsQueryCacheDefault);
+    if (!q) return;
 
     SysCtx ctx = { func, user_data, world };
     ecs_iter_t it = ecs_query_iter(w->ecs, q);
@@ -261,11 +956,212 @@ void ks_ecs_run_query(Ks_Ecs_World world, const char* filter, Ks_System_Func fun
     ecs_query_fini(q);
 }
 
+Ks_Entity ks_ecs_create_system_iter(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Iter_Func func, void* user_data) {
+    IterSysCtx* ctx = new IterSysCtx{ func, user_data, world };
+    ecs_entity_t sys = init_system(world, name, filter, phase_id, sys_iter_trampoline, ctx, iter_ctx_free, false);
+    if (!sys) delete ctx;
+    else ctx->stats = track_system(world, sys);
+    return (Ks_Entity)sys;
+}
+
+Ks_Entity ks_ecs_create_system_parallel(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Iter_Func func, void* user_data) {
+    IterSysCtx* ctx = new IterSysCtx{ func, user_data, world };
+    ecs_entity_t sys = init_system(world, name, filter, phase_id, sys_iter_trampoline, ctx, iter_ctx_free, true);
+    if (!sys) delete ctx;
+    else ctx->stats = track_system(world, sys);
+    return (Ks_Entity)sys;
+}
+
+Ks_Entity ks_ecs_create_system_changed(Ks_Ecs_World world, const char* name, const char* filter, Ks_Entity phase_id, Ks_System_Iter_Func func, void* user_data) {
+    IterSysCtx* ctx = new IterSysCtx{ func, user_data, world };
+    ecs_entity_t sys = init_system(world, name, filter, phase_id, sys_changed_trampoline, ctx, iter_ctx_free, false, KS_QUERY_DETECT_CHANGES);
+    if (!sys) delete ctx;
+    else ctx->stats = track_system(world, sys);
+    return (Ks_Entity)sys;
+}
+
+void ks_ecs_run_query_iter(Ks_Ecs_World world, const char* filter, Ks_System_Iter_Func func, void* user_data) {
+    auto w = get(world);
+    ecs_query_t* q = init_query(world, filter, EcsQueryCacheDefault);
+    if (!q) return;
+
+    IterSysCtx ctx = { func, user_data, world };
+    ecs_iter_t it = ecs_query_iter(w->ecs, q);
+    while (ecs_query_next(&it)) {
+        dispatch_iter(&it, &ctx);
+    }
+
+    ecs_query_fini(q);
+}
+
+static void fill_system_stats(const EcsSystemStats* stats, Ks_Ecs_System_Stats* out) {
+    out->system = (Ks_Entity)stats->system;
+    out->name = stats->name.c_str();
+    out->invocations = stats->invocations;
+    out->table_count = stats->last_tables;
+    out->entity_count = stats->last_entities;
+    out->time_ms = (ks_double)stats->last_ns / 1e6;
+    out->max_time_ms = (ks_double)stats->max_ns / 1e6;
+    out->total_time_ms = (ks_double)stats->total_ns / 1e6;
+}
+
+bool ks_ecs_get_system_stats(Ks_Ecs_World world, Ks_Entity system, Ks_Ecs_System_Stats* out_stats) {
+    if (!world || !out_stats) return false;
+    auto w = get(world);
+
+    auto it = w->system_stats.find((ecs_entity_t)system);
+    if (it == w->system_stats.end()) return false;
+
+    fill_system_stats(it->second, out_stats);
+    return true;
+}
+
+ks_int32 ks_ecs_get_all_system_stats(Ks_Ecs_World world, Ks_Ecs_System_Stats* out_stats, ks_int32 max_count) {
+    if (!world) return 0;
+    auto w = get(world);
+    if (!out_stats) return (ks_int32)w->system_stats.size();
+
+    ks_int32 count = 0;
+    for (auto& [sys, stats] : w->system_stats) {
+        if (count >= max_count) break;
+        fill_system_stats(stats, &out_stats[count++]);
+    }
+    return count;
+}
+
+void ks_ecs_reset_system_stats(Ks_Ecs_World world) {
+    if (!world) return;
+    for (auto& [sys, stats] : get(world)->system_stats) {
+        stats->invocations = 0;
+        stats->last_tables = 0;
+        stats->last_entities = 0;
+        stats->last_ns = 0;
+        stats->max_ns = 0;
+        stats->total_ns = 0;
+    }
+}
+
+void* ks_ecs_iter_field(const Ks_Ecs_Iter* it, ks_int32 index) {
+    const ecs_iter_t* eit = (const ecs_iter_t*)it->_impl;
+    if (index < 0 || index >= eit->field_count) return nullptr;
+    return ecs_field_w_size(eit, 0, (int8_t)index);
+}
+
+ks_size ks_ecs_iter_field_size(const Ks_Ecs_Iter* it, ks_int32 index) {
+    const ecs_iter_t* eit = (const ecs_iter_t*)it->_impl;
+    if (index < 0 || index >= eit->field_count) return 0;
+    return (ks_size)ecs_field_size(eit, (int8_t)index);
+}
+
+bool ks_ecs_iter_field_is_set(const Ks_Ecs_Iter* it, ks_int32 index) {
+    const ecs_iter_t* eit = (const ecs_iter_t*)it->_impl;
+    if (index < 0 || index >= eit->field_count) return false;
+    return ecs_field_is_set(eit, (int8_t)index);
+}
+
+bool ks_ecs_iter_field_is_self(const Ks_Ecs_Iter* it, ks_int32 index) {
+    const ecs_iter_t* eit = (const ecs_iter_t*)it->_impl;
+    if (index < 0 || index >= eit->field_count) return false;
+    return ecs_field_is_self(eit, (int8_t)index);
+}
+
+Ks_Component ks_ecs_iter_field_id(const Ks_Ecs_Iter* it, ks_int32 index) {
+    const ecs_iter_t* eit = (const ecs_iter_t*)it->_impl;
+    if (index < 0 || index >= eit->field_count) return 0;
+    return (Ks_Component)ecs_field_id(eit, (int8_t)index);
+}
+
+static Ks_Ecs_Query create_query(Ks_Ecs_World world, const char* filter, ecs_flags32_t flags) {
+    if (!world || !filter) return nullptr;
+
+    ecs_query_t* q = init_query(world, filter, EcsQueryCacheAuto, flags);
+    if (!q) return nullptr;
+
+    void* mem = ks_alloc_debug(sizeof(Ks_Ecs_Query_Impl), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEcsQuery");
+    Ks_Ecs_Query_Impl* query = new(mem) Ks_Ecs_Query_Impl{ world, q };
+    get(world)->queries.insert(query);
+    return query;
+}
+
+// Lets flecs parse the filter, so or-chains, pairs and access modifiers count
+// exactly as they will in the system built from it. Returns -1 if invalid.
+ks_int32 ks_ecs_filter_field_count(Ks_Ecs_World world, const char* filter) {
+    if (!world || !filter) return -1;
+
+    ecs_query_t* q = init_query(world, filter, EcsQueryCacheNone);
+    if (!q) return -1;
+
+    ks_int32 count = q->field_count;
+    ecs_query_fini(q);
+    return count;
+}
+
+Ks_Ecs_Query ks_ecs_query_create(Ks_Ecs_World world, const char* filter) {
+    return create_query(world, filter, 0);
+}
+
+Ks_Ecs_Query ks_ecs_query_create_changed(Ks_Ecs_World world, const char* filter) {
+    return create_query(world, filter, KS_QUERY_DETECT_CHANGES);
+}
+
+void ks_ecs_query_destroy(Ks_Ecs_Query query) {
+    if (!query) return;
+    auto* q = static_cast<Ks_Ecs_Query_Impl*>(query);
+    auto w = get(q->world);
+    if (w->queries.erase(q) == 0) return;
+
+    ecs_query_fini(q->query);
+    ks_dealloc(q);
+}
+
+void ks_ecs_query_iter(Ks_Ecs_Query query, Ks_System_Iter_Func func, void* user_data) {
+    if (!query || !func) return;
+    auto* q = static_cast<Ks_Ecs_Query_Impl*>(query);
+
+    IterSysCtx ctx = { func, user_data, q->world };
+    ecs_iter_t it = ecs_query_iter(get(q->world)->ecs, q->query);
+    while (ecs_query_next(&it)) {
+        dispatch_iter(&it, &ctx);
+    }
+}
+
+bool ks_ecs_query_changed(Ks_Ecs_Query query) {
+    if (!query) return false;
+    return ecs_query_changed(static_cast<Ks_Ecs_Query_Impl*>(query)->query);
+}
+
+void ks_ecs_query_iter_changed(Ks_Ecs_Query query, Ks_System_Iter_Func func, void* user_data) {
+    if (!query || !func) return;
+    auto* q = static_cast<Ks_Ecs_Query_Impl*>(query);
+
+    IterSysCtx ctx = { func, user_data, q->world };
+    ecs_iter_t it = ecs_query_iter(get(q->world)->ecs, q->query);
+    while (ecs_query_next(&it)) {
+        if (!ecs_iter_changed(&it)) {
+            ecs_iter_skip(&it);
+            continue;
+        }
+        dispatch_iter(&it, &ctx);
+    }
+}
+
+void ks_ecs_query_each(Ks_Ecs_Query query, Ks_System_Func func, void* user_data) {
+    if (!query || !func) return;
+    auto* q = static_cast<Ks_Ecs_Query_Impl*>(query);
+
+    ecs_iter_t it = ecs_query_iter(get(q->world)->ecs, q->query);
+    while (ecs_query_next(&it)) {
+        for (int i = 0; i < it.count; ++i) {
+            func(q->world, (Ks_Entity)it.entities[i], user_data);
+        }
+    }
+}
+
 void ks_ecs_enable_system(Ks_Ecs_World world, Ks_Entity system, bool enabled){
     ecs_enable(get(world)->ecs, (ecs_entity_t)system, enabled);
 }
 
-void ks_ecs_create_observer(Ks_Ecs_World world, Ks_Ecs_Event trigger, const char* component, Ks_System_Func func, void* user_data) {
+Ks_Entity ks_ecs_create_observer(Ks_Ecs_World world, Ks_Ecs_Event trigger, const char* component, Ks_System_Func func, void* user_data) {
     auto w = get(world);
     
     get_component_id(world, component);
@@ -276,10 +1172,581 @@ void ks_ecs_create_observer(Ks_Ecs_World world, Ks_Ecs_Event trigger, const char
     desc.query.expr = component;
     desc.callback = sys_trampoline;
     desc.ctx = ctx;
+    desc.ctx_free = sys_ctx_free;
 
     if (trigger == KS_EVENT_ON_ADD) desc.events[0] = EcsOnAdd;
     else if (trigger == KS_EVENT_ON_REMOVE) desc.events[0] = EcsOnRemove;
     else if (trigger == KS_EVENT_ON_SET) desc.events[0] = EcsOnSet;
 
-    ecs_observer_init(w->ecs, &desc);
-}
\ No newline at end of file
+    return (Ks_Entity)ecs_observer_init(w->ecs, &desc);
+}
+
+struct EcsSnapshotStream {
+    std::vector<ks_byte>* out;
+    const ks_byte* in;
+    ks_size in_size;
+    ks_size pos;
+};
+
+static constexpr ks_uint32 KS_ECS_SNAPSHOT_MAGIC = 0x4E53534B; // "KSSN"
+static constexpr ks_uint32 KS_ECS_SNAPSHOT_VERSION = 2;
+
+// Entity ids and component columns start on 16 byte boundaries so a loaded
+// snapshot can hand them to flecs without copying.
+static constexpr ks_size KS_ECS_SNAPSHOT_ALIGN = 16;
+
+static void snapshot_align(EcsSnapshotStream& s) {
+    s.out->resize((s.out->size() + KS_ECS_SNAPSHOT_ALIGN - 1) & ~(KS_ECS_SNAPSHOT_ALIGN - 1), 0);
+}
+
+static bool snapshot_skip_align(EcsSnapshotStream& s) {
+    ks_size aligned = (s.pos + KS_ECS_SNAPSHOT_ALIGN - 1) & ~(KS_ECS_SNAPSHOT_ALIGN - 1);
+    if (aligned > s.in_size) return false;
+    s.pos = aligned;
+    return true;
+}
+
+template<typename T>
+static void snapshot_put(EcsSnapshotStream& s, const T& value) {
+    ks_ecs_snapshot_write(&s, &value, sizeof(T));
+}
+
+template<typename T>
+static bool snapshot_get(EcsSnapshotStream& s, T& value) {
+    return ks_ecs_snapshot_read(&s, &value, sizeof(T));
+}
+
+void ks_ecs_snapshot_write(Ks_Ecs_Snapshot_Stream stream, const void* data, ks_size size) {
+    auto* s = (EcsSnapshotStream*)stream;
+    if (!s || !s->out || size == 0) return;
+    ks_size offset = s->out->size();
+    s->out->resize(offset + size);
+    memcpy(s->out->data() + offset, data, size);
+}
+
+bool ks_ecs_snapshot_read(Ks_Ecs_Snapshot_Stream stream, void* data, ks_size size) {
+    auto* s = (EcsSnapshotStream*)stream;
+    if (!s || !s->in || size > s->in_size - s->pos) return false;
+    if (data) memcpy(data, s->in + s->pos, size);
+    s->pos += size;
+    return true;
+}
+
+void ks_ecs_set_snapshot_hooks(Ks_Ecs_World world, Ks_Component component, Ks_Ecs_Snapshot_Save_Func save, Ks_Ecs_Snapshot_Load_Func load, Ks_Ecs_Snapshot_Discard_Func discard, void* user_data) {
+    if (!world || !component) return;
+    get(world)->snapshot_hooks[(ecs_id_t)component] = { save, load, discard, user_data };
+}
+
+// Component entities (which also hold singletons) and prefabs are world
+// structure, not simulation state, so they stay out of snapshots. Entities
+// without a single registered component are not captured either.
+static bool is_snapshot_table(ecs_world_t* ecs, const ecs_table_t* table) {
+    return !ecs_table_has_id(ecs, table, ecs_id(EcsComponent)) && !ecs_table_has_id(ecs, table, EcsPrefab);
+}
+
+// Hierarchy and prefab links are kept; other relationships are not.
+static bool is_snapshot_pair(ecs_id_t id) {
+    if (!ecs_id_is_pair(id)) return false;
+    ecs_entity_t rel = (ecs_entity_t)ECS_PAIR_FIRST(id);
+    return rel == EcsChildOf || rel == EcsIsA;
+}
+
+template<typename F>
+static void for_each_snapshot_table(Ks_Ecs_World_Impl* w, F&& func) {
+    std::unordered_set<const ecs_table_t*> visited;
+    for (const auto& [name, id] : w->component_ids) {
+        ecs_iter_t it = ecs_each_id(w->ecs, id);
+        while (ecs_each_next(&it)) {
+            if (!it.table || it.count == 0 || !visited.insert(it.table).second) continue;
+            if (!is_snapshot_table(w->ecs, it.table)) continue;
+            func(it.table, (const ecs_entity_t*)it.entities, it.count);
+        }
+    }
+}
+
+void* ks_ecs_snapshot_save(Ks_Ecs_World world, ks_size* out_size) {
+    if (out_size) *out_size = 0;
+    if (!world) return nullptr;
+    auto w = get(world);
+
+    std::unordered_map<ecs_id_t, const std::string*> names;
+    for (const auto& [name, id] : w->component_ids) names[id] = &name;
+
+    std::vector<ks_byte> buffer;
+    EcsSnapshotStream out = { &buffer, nullptr, 0, 0 };
+
+    snapshot_put(out, KS_ECS_SNAPSHOT_MAGIC);
+    snapshot_put(out, KS_ECS_SNAPSHOT_VERSION);
+    ks_size table_count_offset = buffer.size();
+    snapshot_put(out, (ks_uint32)0);
+
+    ks_uint32 table_count = 0;
+    std::vector<ecs_id_t> ids;
+    std::vector<ecs_id_t> pairs;
+    const ecs_id_t name_id = ecs_pair(ecs_id(EcsIdentifier), EcsName);
+
+    for_each_snapshot_table(w, [&](const ecs_table_t* table, const ecs_entity_t* entities, ks_int32 count) {
+        const ecs_type_t* type = ecs_table_get_type(table);
+        ids.clear();
+        pairs.clear();
+        for (ks_int32 i = 0; i < type->count; ++i) {
+            if (names.count(type->array[i])) ids.push_back(type->array[i]);
+            else if (is_snapshot_pair(type->array[i])) pairs.push_back(type->array[i]);
+        }
+
+        snapshot_put(out, (ks_uint32)ids.size());
+        for (ecs_id_t id : ids) {
+            const std::string& name = *names[id];
+            const ecs_type_info_t* ti = ecs_get_type_info(w->ecs, id);
+            snapshot_put(out, (ks_uint16)name.size());
+            ks_ecs_snapshot_write(&out, name.data(), name.size());
+            snapshot_put(out, (ks_uint32)(ti ? ti->size : 0));
+            snapshot_put(out, (ks_uint8)(w->snapshot_hooks.count(id) ? 1 : 0));
+        }
+
+        snapshot_put(out, (ks_uint32)pairs.size());
+        for (ecs_id_t pair : pairs) snapshot_put(out, (ks_uint64)pair);
+
+        bool named = ecs_table_has_id(w->ecs, table, name_id);
+        snapshot_put(out, (ks_uint8)(named ? 1 : 0));
+
+        snapshot_put(out, (ks_uint32)count);
+        snapshot_align(out);
+        ks_ecs_snapshot_write(&out, entities, sizeof(ecs_entity_t) * (ks_size)count);
+
+        if (named) {
+            for (ks_int32 i = 0; i < count; ++i) {
+                const char* name = ecs_get_name(w->ecs, entities[i]);
+                ks_uint16 len = name ? (ks_uint16)strnlen(name, UINT16_MAX) : 0;
+                snapshot_put(out, len);
+                ks_ecs_snapshot_write(&out, name, len);
+            }
+        }
+
+        for (ecs_id_t id : ids) {
+            ks_int32 column = ecs_table_get_column_index(w->ecs, table, id);
+            const void* data = column >= 0 ? ecs_table_get_column(table, column, 0) : nullptr;
+            const ecs_type_info_t* ti = ecs_get_type_info(w->ecs, id);
+            ks_size size = ti ? (ks_size)ti->size : 0;
+
+            auto hook = w->snapshot_hooks.find(id);
+            if (hook != w->snapshot_hooks.end()) {
+                ks_size size_offset = buffer.size();
+                snapshot_put(out, (ks_uint64)0);
+                if (data && hook->second.save) {
+                    hook->second.save(world, (Ks_Component)id, data, count, &out, hook->second.user_data);
+                }
+                ks_uint64 payload = (ks_uint64)(buffer.size() - size_offset - sizeof(ks_uint64));
+                memcpy(buffer.data() + size_offset, &payload, sizeof(payload));
+            }
+            else if (size > 0 && data) {
+                snapshot_align(out);
+                ks_ecs_snapshot_write(&out, data, size * (ks_size)count);
+            }
+        }
+
+        ++table_count;
+    });
+
+    memcpy(buffer.data() + table_count_offset, &table_count, sizeof(table_count));
+
+    void* result = ks_alloc_debug(buffer.size(), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEcsSnapshot");
+    memcpy(result, buffer.data(), buffer.size());
+    if (out_size) *out_size = buffer.size();
+    return result;
+}
+
+void ks_ecs_snapshot_free(void* data) {
+    if (data) ks_dealloc(data);
+}
+
+struct SnapshotColumn {
+    ecs_id_t id;
+    ks_size size;
+    bool hooked;
+    bool loaded;
+    const void* data;
+    std::vector<ks_byte> owned;
+};
+
+struct SnapshotTable {
+    std::vector<SnapshotColumn> columns;
+    std::vector<ecs_id_t> pairs;
+    std::vector<std::string_view> names;
+    const ecs_entity_t* entities;
+    ks_uint32 count;
+};
+
+// Hands columns a hook already loaded back to it, for loads that fail after
+// the hook ran and so never reach the world.
+static void discard_snapshot_tables(Ks_Ecs_World_Impl* w, std::vector<SnapshotTable>& tables) {
+    for (SnapshotTable& table : tables) {
+        for (SnapshotColumn& col : table.columns) {
+            if (!col.loaded) continue;
+            col.loaded = false;
+
+            auto hook = w->snapshot_hooks.find(col.id);
+            if (hook != w->snapshot_hooks.end() && hook->second.discard) {
+                hook->second.discard((Ks_Ecs_World)w, (Ks_Component)col.id, col.owned.data(), (ks_int32)table.count, hook->second.user_data);
+            }
+        }
+    }
+}
+
+// Reads every table and runs the load hooks without touching the world, so a
+// truncated or mismatched snapshot leaves the current state intact.
+static bool parse_snapshot(Ks_Ecs_World world, EcsSnapshotStream& in, ks_uint32 table_count, std::vector<SnapshotTable>& tables) {
+    auto w = get(world);
+    auto corrupt = []() {
+        ks_epush_s(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::SNAPSHOT_LOAD_FAIL, "ECS snapshot is truncated or corrupt");
+        return false;
+    };
+
+    std::string name;
+    tables.reserve(table_count);
+
+    for (ks_uint32 t = 0; t < table_count; ++t) {
+        SnapshotTable& table = tables.emplace_back();
+
+        ks_uint32 component_count = 0;
+        if (!snapshot_get(in, component_count) || component_count > in.in_size - in.pos) return corrupt();
+
+        table.columns.resize(component_count);
+        for (auto& col : table.columns) {
+            ks_uint16 name_len = 0;
+            ks_uint32 elem_size = 0;
+            ks_uint8 hooked = 0;
+            if (!snapshot_get(in, name_len)) return corrupt();
+            name.resize(name_len);
+            if (!ks_ecs_snapshot_read(&in, name.data(), name_len)) return corrupt();
+            if (!snapshot_get(in, elem_size) || !snapshot_get(in, hooked)) return corrupt();
+
+            col.id = get_component_id(world, name.c_str());
+            const ecs_type_info_t* ti = ecs_get_type_info(w->ecs, col.id);
+            col.size = ti ? (ks_size)ti->size : 0;
+            col.hooked = hooked != 0;
+            col.loaded = false;
+            col.data = nullptr;
+
+            if (col.size != elem_size) {
+                ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::SNAPSHOT_LOAD_FAIL, "Snapshot component '%s' has size %u, world expects %u", name.c_str(), elem_size, (ks_uint32)col.size);
+                return false;
+            }
+        }
+
+        ks_uint32 pair_count = 0;
+        if (!snapshot_get(in, pair_count) || pair_count > in.in_size - in.pos) return corrupt();
+        table.pairs.resize(pair_count);
+        for (ecs_id_t& pair : table.pairs) {
+            ks_uint64 raw = 0;
+            if (!snapshot_get(in, raw) || !is_snapshot_pair((ecs_id_t)raw)) return corrupt();
+            pair = (ecs_id_t)raw;
+        }
+
+        ks_uint8 named = 0;
+        if (!snapshot_get(in, named)) return corrupt();
+
+        if (!snapshot_get(in, table.count) || !snapshot_skip_align(in)) return corrupt();
+        table.entities = (const ecs_entity_t*)(in.in + in.pos);
+        if (table.count > (in.in_size - in.pos) / sizeof(ecs_entity_t)) return corrupt();
+        in.pos += sizeof(ecs_entity_t) * table.count;
+
+        if (named) {
+            table.names.resize(table.count);
+            for (std::string_view& entity_name : table.names) {
+                ks_uint16 len = 0;
+                if (!snapshot_get(in, len) || len > in.in_size - in.pos) return corrupt();
+                entity_name = std::string_view((const char*)in.in + in.pos, len);
+                in.pos += len;
+            }
+        }
+
+        for (auto& col : table.columns) {
+            if (col.hooked) {
+                ks_uint64 payload = 0;
+                if (!snapshot_get(in, payload) || payload > in.in_size - in.pos) return corrupt();
+
+                EcsSnapshotStream sub = { nullptr, in.in + in.pos, (ks_size)payload, 0 };
+                in.pos += (ks_size)payload;
+
+                col.owned.assign(col.size * table.count, 0);
+                col.data = col.owned.data();
+
+                // A failing hook releases whatever it loaded itself.
+                auto hook = w->snapshot_hooks.find(col.id);
+                if (hook == w->snapshot_hooks.end() || !hook->second.load ||
+                    !hook->second.load(world, (Ks_Component)col.id, col.owned.data(), (ks_int32)table.count, &sub, hook->second.user_data)) {
+                    ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::SNAPSHOT_LOAD_FAIL, "No snapshot load hook restored component '%s'", ecs_get_name(w->ecs, col.id));
+                    return false;
+                }
+                col.loaded = true;
+            }
+            else if (col.size > 0) {
+                if (!snapshot_skip_align(in)) return corrupt();
+                col.data = in.in + in.pos;
+                if (table.count > (in.in_size - in.pos) / col.size) return corrupt();
+                in.pos += col.size * table.count;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void commit_snapshot_table(Ks_Ecs_World_Impl* w, const SnapshotTable& table) {
+    const auto& columns = table.columns;
+    const ecs_entity_t* entities = table.entities;
+    ks_uint32 count = table.count;
+
+    bool all_free = true;
+    for (ks_uint32 i = 0; i < count && all_free; ++i) {
+        all_free = !ecs_is_alive(w->ecs, entities[i]);
+    }
+
+    ks_int32 bulk_components = 0;
+    if (all_free && count > 0) {
+        ecs_bulk_desc_t desc = { 0 };
+        void* bulk_data[FLECS_ID_DESC_MAX] = { 0 };
+
+        bulk_components = (ks_int32)columns.size() < FLECS_ID_DESC_MAX - 1 ? (ks_int32)columns.size() : FLECS_ID_DESC_MAX - 1;
+        for (ks_int32 c = 0; c < bulk_components; ++c) {
+            desc.ids[c] = columns[c].id;
+            bulk_data[c] = (void*)columns[c].data;
+        }
+        desc.entities = (ecs_entity_t*)entities;
+        desc.count = (int32_t)count;
+        desc.data = bulk_data;
+        ecs_bulk_init(w->ecs, &desc);
+    }
+
+    if (all_free && bulk_components == (ks_int32)columns.size()) return;
+
+    for (ks_uint32 i = 0; i < count; ++i) {
+        ecs_make_alive(w->ecs, entities[i]);
+        for (ks_size c = (ks_size)bulk_components; c < columns.size(); ++c) {
+            const SnapshotColumn& col = columns[c];
+            if (col.size > 0 && col.data) {
+                ecs_set_id(w->ecs, entities[i], col.id, col.size, (const ks_byte*)col.data + col.size * i);
+            }
+            else {
+                ecs_add_id(w->ecs, entities[i], col.id);
+            }
+        }
+    }
+}
+
+// A table whose entities still sit together, in order, in a table of the
+// same shape can be restored without moving them. Hierarchies, names and hook
+// columns always take the rebuild path.
+static ecs_table_t* match_in_place(Ks_Ecs_World_Impl* w, const SnapshotTable& table) {
+    if (table.count == 0 || !table.names.empty()) return nullptr;
+    for (ecs_id_t pair : table.pairs) {
+        if ((ecs_entity_t)ECS_PAIR_FIRST(pair) == EcsChildOf) return nullptr;
+    }
+    for (const SnapshotColumn& col : table.columns) {
+        if (col.hooked) return nullptr;
+    }
+
+    if (!ecs_is_alive(w->ecs, table.entities[0])) return nullptr;
+    ecs_table_t* cur = ecs_get_table(w->ecs, table.entities[0]);
+    if (!cur || ecs_table_count(cur) != (int32_t)table.count || !is_snapshot_table(w->ecs, cur)) return nullptr;
+    if (ecs_table_has_id(w->ecs, cur, ecs_pair(ecs_id(EcsIdentifier), EcsName))) return nullptr;
+    if (memcmp(ecs_table_entities(cur), table.entities, sizeof(ecs_entity_t) * table.count) != 0) return nullptr;
+
+    const ecs_type_t* type = ecs_table_get_type(cur);
+    ks_size c = 0, p = 0;
+    for (ks_int32 i = 0; i < type->count; ++i) {
+        ecs_id_t id = type->array[i];
+        if (w->ids_to_type_info.count(id)) {
+            if (c >= table.columns.size() || table.columns[c].id != id) return nullptr;
+            ++c;
+        }
+        else if (is_snapshot_pair(id)) {
+            if (p >= table.pairs.size() || table.pairs[p] != id) return nullptr;
+            ++p;
+        }
+    }
+    return c == table.columns.size() && p == table.pairs.size() ? cur : nullptr;
+}
+
+// Only rows that differ are written, and those get the same OnSet and change
+// tracking a regular set would, so an unchanged world restores in one memcmp.
+static void restore_in_place(Ks_Ecs_World_Impl* w, ecs_table_t* cur, const SnapshotTable& table) {
+    for (const SnapshotColumn& col : table.columns) {
+        if (col.size == 0 || !col.data) continue;
+
+        ks_int32 index = ecs_table_get_column_index(w->ecs, cur, col.id);
+        ks_byte* dst = index >= 0 ? (ks_byte*)ecs_table_get_column(cur, index, 0) : nullptr;
+        if (!dst) continue;
+
+        const ks_byte* src = (const ks_byte*)col.data;
+        for (ks_uint32 i = 0; i < table.count; ++i) {
+            ks_size offset = col.size * i;
+            if (memcmp(dst + offset, src + offset, col.size) == 0) continue;
+            memcpy(dst + offset, src + offset, col.size);
+            ecs_modified_id(w->ecs, table.entities[i], col.id);
+        }
+    }
+}
+
+bool ks_ecs_snapshot_load(Ks_Ecs_World world, const void* data, ks_size size) {
+    if (!world || !data) return false;
+    auto w = get(world);
+
+    EcsSnapshotStream in = { nullptr, (const ks_byte*)data, size, 0 };
+
+    ks_uint32 magic = 0, version = 0, table_count = 0;
+    if (!snapshot_get(in, magic) || magic != KS_ECS_SNAPSHOT_MAGIC ||
+        !snapshot_get(in, version) || version != KS_ECS_SNAPSHOT_VERSION ||
+        !snapshot_get(in, table_count)) {
+        ks_epush_s(KS_ERROR_LEVEL_BASE, "ECS", ECSErros::SNAPSHOT_LOAD_FAIL, "Invalid ECS snapshot header");
+        return false;
+    }
+
+    std::vector<SnapshotTable> tables;
+    if (!parse_snapshot(world, in, table_count, tables)) {
+        discard_snapshot_tables(w, tables);
+        return false;
+    }
+
+    std::vector<ecs_table_t*> in_place(tables.size(), nullptr);
+    std::unordered_set<const ecs_table_t*> kept;
+    for (ks_size t = 0; t < tables.size(); ++t) {
+        in_place[t] = match_in_place(w, tables[t]);
+        if (in_place[t]) kept.insert(in_place[t]);
+    }
+
+    std::vector<ecs_entity_t> stale;
+    for_each_snapshot_table(w, [&](const ecs_table_t* table, const ecs_entity_t* entities, ks_int32 count) {
+        if (!kept.count(table)) stale.insert(stale.end(), entities, entities + count);
+    });
+    for (ecs_entity_t e : stale) ecs_delete(w->ecs, e);
+
+    for (ks_size t = 0; t < tables.size(); ++t) {
+        if (!in_place[t]) commit_snapshot_table(w, tables[t]);
+    }
+
+    // OnSet observers may move entities; deferring keeps the column pointers
+    // valid until every in-place table is written.
+    ecs_defer_begin(w->ecs);
+    for (ks_size t = 0; t < tables.size(); ++t) {
+        if (in_place[t]) restore_in_place(w, in_place[t], tables[t]);
+    }
+    ecs_defer_end(w->ecs);
+
+    // Links and names go on once every entity exists, since a parent may live
+    // in a table that is restored after its children.
+    for (ks_size t = 0; t < tables.size(); ++t) {
+        const SnapshotTable& table = tables[t];
+        if (in_place[t] || (table.pairs.empty() && table.names.empty())) continue;
+
+        std::string entity_name;
+        for (ks_uint32 i = 0; i < table.count; ++i) {
+            for (ecs_id_t pair : table.pairs) ecs_add_id(w->ecs, table.entities[i], pair);
+            if (!table.names.empty() && !table.names[i].empty()) {
+                entity_name.assign(table.names[i]);
+                ecs_set_name(w->ecs, table.entities[i], entity_name.c_str());
+            }
+        }
+    }
+
+    return true;
+}
+
+// Acquire only pins the front frame, so once the back frame is seen free
+// under the lock no reader can reach it until it is published.
+static bool run_extraction(Ks_Ecs_World_Impl* w) {
+    EcsExtractState& x = w->extract;
+    if (x.components.empty()) return false;
+    KS_PROFILE_SCOPE("EcsExtract");
+
+    ks_int32 back;
+    {
+        std::lock_guard<std::mutex> lock(x.mutex);
+        back = x.front < 0 ? 0 : 1 - x.front;
+        if (x.frames[back].readers > 0) return false;
+    }
+
+    EcsExtractFrame& frame = x.frames[back];
+    frame.columns.resize(x.components.size());
+
+    for (ks_size c = 0; c < x.components.size(); ++c) {
+        EcsExtractColumn& col = frame.columns[c];
+        const ecs_type_info_t* ti = ecs_get_type_info(w->ecs, x.components[c].second);
+        col.id = x.components[c].second;
+        col.name = x.components[c].first;
+        col.size = ti ? (ks_size)ti->size : 0;
+        col.entities.clear();
+        col.data.clear();
+
+        ecs_iter_t it = ecs_each_id(w->ecs, col.id);
+        while (ecs_each_next(&it)) {
+            if (!it.table || it.count == 0 || !is_snapshot_table(w->ecs, it.table)) continue;
+            col.entities.insert(col.entities.end(), it.entities, it.entities + it.count);
+            if (col.size == 0) continue;
+
+            ks_int32 column = ecs_table_get_column_index(w->ecs, it.table, col.id);
+            const void* src = column >= 0 ? ecs_table_get_column(it.table, column, 0) : nullptr;
+            ks_size offset = col.data.size();
+            col.data.resize(offset + col.size * (ks_size)it.count);
+            if (src) memcpy(col.data.data() + offset, src, col.size * (ks_size)it.count);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(x.mutex);
+    frame.index = ++x.counter;
+    x.front = back;
+    return true;
+}
+
+void ks_ecs_extract_register(Ks_Ecs_World world, const char* type_name) {
+    if (!world || !type_name) return;
+    auto w = get(world);
+    ecs_entity_t id = get_component_id(world, type_name);
+    for (const auto& [name, existing] : w->extract.components) {
+        if (existing == id) return;
+    }
+    w->extract.components.push_back({ type_name, id });
+}
+
+void ks_ecs_extract_set_auto(Ks_Ecs_World world, bool enabled) {
+    if (world) get(world)->extract.auto_extract = enabled;
+}
+
+bool ks_ecs_extract(Ks_Ecs_World world) {
+    return world && run_extraction(get(world));
+}
+
+Ks_Ecs_Extract_Frame ks_ecs_extract_acquire(Ks_Ecs_World world) {
+    if (!world) return nullptr;
+    EcsExtractState& x = get(world)->extract;
+    std::lock_guard<std::mutex> lock(x.mutex);
+    if (x.front < 0) return nullptr;
+    x.frames[x.front].readers++;
+    return &x.frames[x.front];
+}
+
+void ks_ecs_extract_release(Ks_Ecs_Extract_Frame frame) {
+    if (!frame) return;
+    EcsExtractFrame* f = static_cast<EcsExtractFrame*>(frame);
+    std::lock_guard<std::mutex> lock(f->state->mutex);
+    f->readers--;
+}
+
+ks_uint64 ks_ecs_extract_frame_index(Ks_Ecs_Extract_Frame frame) {
+    return frame ? static_cast<EcsExtractFrame*>(frame)->index : 0;
+}
+
+bool ks_ecs_extract_get(Ks_Ecs_Extract_Frame frame, const char* type_name, Ks_Ecs_Extract_Column* out_column) {
+    if (!frame || !type_name || !out_column) return false;
+    for (const EcsExtractColumn& col : static_cast<EcsExtractFrame*>(frame)->columns) {
+        if (col.name != type_name) continue;
+        out_column->component = (Ks_Component)col.id;
+        out_column->entities = (const Ks_Entity*)col.entities.data();
+        out_column->data = col.size > 0 ? col.data.data() : nullptr;
+        out_column->stride = col.size;
+        out_column->count = (ks_int32)col.entities.size();
+        return true;
+    }
+    return false;
+}
@@ -1,14 +1,18 @@
 #include "../include/ecs/ecs_binding.h"
+#include "../include/ecs/spatial.h"
 #include "../include/core/log.h"
 #include "../include/core/reflection.h"
 #include "../include/memory/memory.h"
 #include <string.h>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <string.h>
 #include <mutex>
 #include <unordered_set>
+#include <unordered_map>
 #include <map>
+#include <algorithm>
 
 typedef struct ScriptComponent {
     int ref;
@@ -29,11 +33,100 @@ struct LuaCallbackCtx {
     int function_ref;
 };
 
+enum EcsColumnKind {
+    ECS_COLUMN_ENTITY,
+    ECS_COLUMN_NATIVE,
+    ECS_COLUMN_SCRIPT,
+    ECS_COLUMN_NONE
+};
+
+struct LuaBatchCtx;
+
+struct EcsColumnView {
+    ks_byte* base;
+    ks_size stride;
+    ks_int32 count;
+    EcsColumnKind kind;
+    const Ks_Type_Info* info;
+    LuaBatchCtx* batch;
+};
+
+// One reflected field of a native column: col.x[i] reads or writes row i in
+// place, so a batch loop touches no userdata per entity.
+struct EcsFieldView {
+    const EcsColumnView* column;
+    const Ks_Type_Info* info;
+    ks_size offset;
+    Ks_Type type;
+};
+
+struct LuaFieldViewRef {
+    const EcsColumnView* column;
+    const Ks_Type_Info* info;
+    ks_size field;
+    Ks_Script_Userdata view;
+};
+
+static constexpr ks_int32 KS_LUA_BATCH_MAX_FIELDS = 16;
+
+struct LuaBatchCtx {
+    Ks_Script_Ctx ctx;
+    int function_ref;
+    ks_int32 field_count;
+    Ks_Script_Userdata views[KS_LUA_BATCH_MAX_FIELDS + 1];
+    EcsColumnView* view_ptrs[KS_LUA_BATCH_MAX_FIELDS + 1];
+    std::vector<LuaFieldViewRef> field_views;
+};
+
+struct NativeLayoutField {
+    std::string name;
+    Ks_Type type;
+    ks_size offset;
+};
+
+// Component declared from Lua with a typed field layout: the data lives
+// inline in the ECS column and Lua reaches it through the reflected
+// usertype's offset accessors instead of a registry table.
+struct NativeLayout {
+    std::string type_name;
+    ks_size size;
+    std::vector<NativeLayoutField> fields;
+    std::vector<ks_byte> defaults;
+};
+
+struct LuaQueryHandle {
+    Ks_Ecs_World world;
+    Ks_Ecs_Query query;
+};
+
+struct LuaSpatialHandle {
+    Ks_Ecs_World world;
+    Ks_Ecs_Spatial index;
+};
+
+struct ComponentLookup {
+    Ks_Component id;
+    const Ks_Type_Info* info;
+    bool script;
+};
+
+struct StringViewHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
 static std::mutex s_binding_mutex;
 static std::vector<std::string> s_script_component_types;
 static std::unordered_set<std::string> g_registered_observers;
 static std::vector<ScriptCleanupCtx*> s_cleanup_contexts;
 static std::vector<LuaCallbackCtx*> s_callback_contexts;
+static std::vector<LuaBatchCtx*> s_batch_contexts;
+static std::unordered_map<Ks_Ecs_World, std::unordered_map<std::string, ComponentLookup, StringViewHash, std::equal_to<>>> s_component_lookup;
+static std::unordered_map<Ks_Ecs_World, std::unordered_map<std::string, Ks_Ecs_Query, StringViewHash, std::equal_to<>>> s_query_cache;
+static std::unordered_set<LuaQueryHandle*> s_lua_queries;
+static std::unordered_set<Ks_Ecs_Spatial> s_lua_spatial;
+static std::unordered_map<std::string, NativeLayout*> s_native_layouts;
+static std::vector<NativeLayout*> s_native_redeclared;
 
 static bool is_script_component(const char* name) {
     std::lock_guard<std::mutex> lock(s_binding_mutex);
@@ -43,6 +136,22 @@ static bool is_script_component(const char* name) {
     return false;
 }
 
+// Ids are cached per world. A name that is neither reflected nor declared as
+// a script component yet is resolved but not cached, so registering its
+// reflection later is still picked up.
+// Returned by value: misses are not cached, and a cached entry can be erased
+// when its world is destroyed.
+static ComponentLookup lookup_component(Ks_Ecs_World world, const char* type_name) {
+    auto& cache = s_component_lookup[world];
+    auto it = cache.find(std::string_view(type_name));
+    if (it != cache.end()) return it->second;
+
+    ComponentLookup entry = { ks_ecs_component_id(world, type_name), ks_reflection_get_type(type_name), false };
+    entry.script = !entry.info && is_script_component(type_name);
+    if (entry.info || entry.script) cache.emplace(type_name, entry);
+    return entry;
+}
+
 static void lua_ecs_callback_thunk(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
     LuaCallbackCtx* cb_ctx = (LuaCallbackCtx*)user_data;
     if (!cb_ctx) return;
@@ -65,25 +174,298 @@ static void lua_ecs_callback_thunk(Ks_Ecs_World world, Ks_Entity entity, void* u
     }
 }
 
+static void lua_ecs_batch_thunk(Ks_Ecs_Iter* it) {
+    LuaBatchCtx* batch = (LuaBatchCtx*)it->user_data;
+    if (!batch || it->count <= 0) return;
+
+    Ks_Script_Ctx ctx = batch->ctx;
+
+    EcsColumnView* ids = batch->view_ptrs[0];
+    ids->base = (ks_byte*)it->entities;
+    ids->stride = sizeof(Ks_Entity);
+    ids->count = it->count;
+
+    ks_int32 fields = it->field_count < batch->field_count ? it->field_count : batch->field_count;
+
+    for (ks_int32 i = 0; i < batch->field_count; ++i) {
+        EcsColumnView* view = batch->view_ptrs[i + 1];
+        view->base = nullptr;
+        view->count = 0;
+        view->kind = ECS_COLUMN_NONE;
+
+        if (i >= fields || !ks_ecs_iter_field_is_set(it, i)) continue;
+
+        const char* name = ks_ecs_get_name(it->world, (Ks_Entity)ks_ecs_iter_field_id(it, i));
+        if (!name) continue;
+
+        ComponentLookup comp = lookup_component(it->world, name);
+
+        view->base = (ks_byte*)ks_ecs_iter_field(it, i);
+        view->stride = ks_ecs_iter_field_is_self(it, i) ? ks_ecs_iter_field_size(it, i) : 0;
+        view->count = it->count;
+        view->kind = comp.info ? ECS_COLUMN_NATIVE : comp.script ? ECS_COLUMN_SCRIPT : ECS_COLUMN_NONE;
+        view->info = comp.info;
+    }
+
+    Ks_Script_Function func_obj;
+    func_obj.type = KS_TYPE_SCRIPT_FUNCTION;
+    func_obj.state = KS_SCRIPT_OBJECT_VALID;
+    func_obj.val.function_ref = batch->function_ref;
+
+    ks_size base = ks_script_stack_size(ctx);
+    ks_script_stack_push_integer(ctx, it->count);
+    for (ks_int32 i = 0; i <= batch->field_count; ++i) {
+        ks_script_stack_push_obj(ctx, batch->views[i]);
+    }
+
+    // A successful call always leaves the one requested result behind, a
+    // failed one leaves nothing.
+    ks_script_func_call(ctx, func_obj, batch->field_count + 2, 1);
+    if (ks_script_stack_size(ctx) != base + 1) {
+        KS_LOG_ERROR("Lua ECS: Batch system callback failed on %d entities", it->count);
+    }
+    while (ks_script_stack_size(ctx) > base) {
+        ks_script_stack_remove(ctx, -1);
+    }
+}
+
+// Prefab instances start out holding their prefab's table ref. Refs owned by
+// a prefab are recorded here: an instance never frees one and clones it the
+// first time it touches it, and the prefab hands a clone to every instance
+// still holding it before letting go.
+static std::mutex s_shared_mutex;
+static std::unordered_map<Ks_Script_Ctx, std::unordered_set<int>> s_shared_refs;
+
+static bool is_shared_script_ref(Ks_Script_Ctx ctx, int ref) {
+    if (ref == KS_SCRIPT_NO_REF) return false;
+    std::lock_guard<std::mutex> lock(s_shared_mutex);
+    auto found = s_shared_refs.find(ctx);
+    return found != s_shared_refs.end() && found->second.count(ref) != 0;
+}
+
+static int clone_script_component_data(Ks_Script_Ctx ctx, int old_ref);
+
+// Only for instances; a prefab reads its own ref directly.
+static int own_script_component(Ks_Script_Ctx ctx, ScriptComponent* wrapper) {
+    if (is_shared_script_ref(ctx, wrapper->ref)) {
+        wrapper->ref = clone_script_component_data(ctx, wrapper->ref);
+    }
+    return wrapper->ref;
+}
+
+struct UnshareCtx {
+    Ks_Script_Ctx ctx;
+    const char* type_name;
+    int ref;
+};
+
+static void unshare_instance(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
+    auto* un = (UnshareCtx*)user_data;
+    auto* wrapper = (ScriptComponent*)ks_ecs_get_component_mut(world, entity, un->type_name);
+    if (wrapper && wrapper->ref == un->ref) {
+        wrapper->ref = clone_script_component_data(un->ctx, un->ref);
+    }
+}
+
+static void release_script_component(Ks_Script_Ctx ctx, Ks_Ecs_World world, Ks_Entity entity, const char* type_name, ScriptComponent* wrapper) {
+    if (wrapper->ref == KS_SCRIPT_NO_REF) return;
+
+    bool prefab = ks_ecs_is_prefab(world, entity);
+    if (prefab) {
+        bool was_shared = false;
+        {
+            std::lock_guard<std::mutex> lock(s_shared_mutex);
+            auto found = s_shared_refs.find(ctx);
+            if (found != s_shared_refs.end()) was_shared = found->second.erase(wrapper->ref) != 0;
+        }
+        if (was_shared) {
+            UnshareCtx un = { ctx, type_name, wrapper->ref };
+            ks_ecs_run_query(world, type_name, unshare_instance, &un);
+        }
+    }
+
+    if (prefab || !is_shared_script_ref(ctx, wrapper->ref)) {
+        Ks_Script_Object obj;
+        obj.type = KS_TYPE_SCRIPT_TABLE;
+        obj.state = KS_SCRIPT_OBJECT_VALID;
+        obj.val.table_ref = wrapper->ref;
+        ks_script_free_obj(ctx, obj);
+    }
+    wrapper->ref = KS_SCRIPT_NO_REF;
+}
+
+static ks_returns_count l_column_view_index(Ks_Script_Ctx ctx) {
+    ks_script_begin_scope(ctx);
+
+    auto* view = (EcsColumnView*)ks_script_usertype_get_ptr(ctx, ks_script_get_arg(ctx, 1));
+    ks_int64 index = ks_script_obj_as_integer(ctx, ks_script_get_arg(ctx, 2));
+
+    if (!view || !view->base || index < 1 || index > view->count) {
+        ks_script_stack_push_obj(ctx, ks_script_create_nil(ctx));
+        ks_script_end_scope(ctx);
+        return 1;
+    }
+
+    ks_byte* ptr = view->base + (ks_size)(index - 1) * view->stride;
+
+    switch (view->kind) {
+    case ECS_COLUMN_ENTITY:
+        ks_script_stack_push_integer(ctx, (ks_int64)*(Ks_Entity*)ptr);
+        break;
+    case ECS_COLUMN_NATIVE:
+        // Materializes a usertype per row; hot loops use col.field[i].
+        ks_script_stack_push_obj(ctx, ks_script_create_usertype_ref(ctx, view->info->name, ptr));
+        break;
+    case ECS_COLUMN_SCRIPT: {
+        Ks_Script_Object tbl;
+        tbl.type = KS_TYPE_SCRIPT_TABLE;
+        tbl.state = KS_SCRIPT_OBJECT_VALID;
+        tbl.val.table_ref = own_script_component(ctx, (ScriptComponent*)ptr);
+        ks_script_stack_push_obj(ctx, tbl);
+        break;
+    }
+    default:
+        ks_script_stack_push_obj(ctx, ks_script_create_nil(ctx));
+        break;
+    }
+
+    ks_script_end_scope(ctx);
+    return 1;
+}
+
+static bool is_field_view_type(const Ks_Field_Info& f) {
+    if (f.is_array || f.is_bitfield || f.is_function_ptr || f.ptr_depth > 0) return false;
+    switch (f.type) {
+    case KS_TYPE_INT:
+    case KS_TYPE_UINT:
+    case KS_TYPE_FLOAT:
+    case KS_TYPE_DOUBLE:
+    case KS_TYPE_BOOL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static ks_returns_count l_column_view_field(Ks_Script_Ctx ctx) {
+    auto* view = (EcsColumnView*)ks_script_usertype_get_ptr(ctx, ks_script_get_arg(ctx, 1));
+    const char* name = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 2));
+
+    ks_size field = 0;
+    if (view && name && view->kind == ECS_COLUMN_NATIVE && view->info) {
+        while (field < view->info->field_count && strcmp(view->info->fields[field].name, name) != 0) ++field;
+    }
+
+    if (!view || field >= (view->info ? view->info->field_count : 0) || !is_field_view_type(view->info->fields[field])) {
+        ks_script_begin_scope(ctx);
+        ks_script_stack_push_obj(ctx, ks_script_create_nil(ctx));
+        ks_script_end_scope(ctx);
+        return 1;
+    }
+
+    for (const LuaFieldViewRef& ref : view->batch->field_views) {
+        if (ref.column == view && ref.info == view->info && ref.field == field) {
+            ks_script_stack_push_obj(ctx, ref.view);
+            return 1;
+        }
+    }
+
+    const Ks_Field_Info& f = view->info->fields[field];
+    Ks_Script_Userdata ud = ks_script_create_usertype_instance(ctx, "EcsFieldView");
+    auto* fv = (EcsFieldView*)ks_script_usertype_get_ptr(ctx, ud);
+    if (!fv) return 0;
+    *fv = { view, view->info, f.offset, f.type };
+
+    view->batch->field_views.push_back({ view, view->info, field, ud });
+    ks_script_stack_push_obj(ctx, ud);
+    return 1;
+}
+
+// Resolves row `index` of a field view, or null once the column has moved on
+// to a chunk of another type or the index is out of range.
+static ks_byte* field_view_ptr(const EcsFieldView* fv, ks_int64 index) {
+    if (!fv) return nullptr;
+    const EcsColumnView* column = fv->column;
+    if (!column->base || column->info != fv->info || index < 1 || index > column->count) return nullptr;
+    return column->base + (ks_size)(index - 1) * column->stride + fv->offset;
+}
+
+static ks_returns_count l_field_view_index(Ks_Script_Ctx ctx) {
+    auto* fv = (EcsFieldView*)ks_script_usertype_get_ptr(ctx, ks_script_get_arg(ctx, 1));
+    ks_byte* ptr = field_view_ptr(fv, ks_script_obj_as_integer(ctx, ks_script_get_arg(ctx, 2)));
+
+    if (!ptr) {
+        ks_script_begin_scope(ctx);
+        ks_script_stack_push_obj(ctx, ks_script_create_nil(ctx));
+        ks_script_end_scope(ctx);
+        return 1;
+    }
+
+    switch (fv->type) {
+    case KS_TYPE_INT:    ks_script_stack_push_integer(ctx, *(ks_int*)ptr); break;
+    case KS_TYPE_UINT:   ks_script_stack_push_integer(ctx, *(ks_uint32*)ptr); break;
+    case KS_TYPE_FLOAT:  ks_script_stack_push_number(ctx, *(ks_float*)ptr); break;
+    case KS_TYPE_DOUBLE: ks_script_stack_push_number(ctx, *(ks_double*)ptr); break;
+    default:             ks_script_stack_push_boolean(ctx, *(ks_bool*)ptr); break;
+    }
+    return 1;
+}
+
+static ks_returns_count l_field_view_newindex(Ks_Script_Ctx ctx) {
+    auto* fv = (EcsFieldView*)ks_script_usertype_get_ptr(ctx, ks_script_get_arg(ctx, 1));
+    ks_byte* ptr = field_view_ptr(fv, ks_script_obj_as_integer(ctx, ks_script_get_arg(ctx, 2)));
+    if (!ptr) return 0;
+
+    Ks_Script_Object value = ks_script_get_arg(ctx, 3);
+    switch (fv->type) {
+    case KS_TYPE_INT:    *(ks_int*)ptr = (ks_int)ks_script_obj_as_integer_or(ctx, value, 0); break;
+    case KS_TYPE_UINT:   *(ks_uint32*)ptr = (ks_uint32)ks_script_obj_as_integer_or(ctx, value, 0); break;
+    case KS_TYPE_FLOAT:  *(ks_float*)ptr = (ks_float)ks_script_obj_as_number_or(ctx, value, 0.0); break;
+    case KS_TYPE_DOUBLE: *(ks_double*)ptr = ks_script_obj_as_number_or(ctx, value, 0.0); break;
+    default:             *(ks_bool*)ptr = ks_script_obj_as_boolean_or(ctx, value, ks_false); break;
+    }
+    return 0;
+}
+
 static void on_script_component_remove(Ks_Ecs_World w, Ks_Entity e, void* user_data) {
     ScriptCleanupCtx* clean_ctx = (ScriptCleanupCtx*)user_data;
 
     const void* data = ks_ecs_get_component(w, e, clean_ctx->type_name);
 
     if (data) {
-        auto* wrapper = (ScriptComponent*)data;
-        if (wrapper->ref != KS_SCRIPT_NO_REF) {
-
-            Ks_Script_Object obj;
-            obj.state = KS_SCRIPT_OBJECT_VALID;
-            obj.type = KS_TYPE_SCRIPT_TABLE;
-            obj.val.table_ref = wrapper->ref;
-            ks_script_free_obj(clean_ctx->ctx, obj);
-            wrapper->ref = KS_SCRIPT_NO_REF;
+        release_script_component(clean_ctx->ctx, w, e, clean_ctx->type_name, (ScriptComponent*)data);
+    }
+}
+
+// Queries die with their world: the cached ones are destroyed and live Lua
+// handles are emptied, so a later __gc has nothing left to release.
+static void release_world_queries(Ks_Ecs_World world) {
+    auto cached = s_query_cache.find(world);
+    if (cached != s_query_cache.end()) {
+        for (auto& [signature, query] : cached->second) {
+            ks_ecs_query_destroy(query);
         }
+        s_query_cache.erase(cached);
+    }
+
+    for (auto it = s_lua_queries.begin(); it != s_lua_queries.end();) {
+        LuaQueryHandle* handle = *it;
+        if (handle->world != world) {
+            ++it;
+            continue;
+        }
+        ks_ecs_query_destroy(handle->query);
+        handle->query = nullptr;
+        it = s_lua_queries.erase(it);
     }
 }
 
+static void on_world_destroy(Ks_Ecs_World world, void* user_data) {
+    std::lock_guard<std::mutex> lock(s_binding_mutex);
+    release_world_queries(world);
+    s_component_lookup.erase(world);
+}
+
 KS_API ks_no_ret ks_ecs_lua_shutdown(Ks_Ecs_World world) {
     std::lock_guard<std::mutex> lock(s_binding_mutex);
 
@@ -97,8 +479,36 @@ KS_API ks_no_ret ks_ecs_lua_shutdown(Ks_Ecs_World world) {
     }
     s_callback_contexts.clear();
 
+    for (auto* ctx : s_batch_contexts) {
+        ctx->~LuaBatchCtx();
+        ks_dealloc(ctx);
+    }
+    s_batch_contexts.clear();
+
+    release_world_queries(world);
+
+    for (auto index : s_lua_spatial) {
+        ks_ecs_spatial_destroy(index);
+    }
+    s_lua_spatial.clear();
+
+    for (auto& [name, layout] : s_native_layouts) {
+        layout->~NativeLayout();
+        ks_dealloc(layout);
+    }
+    s_native_layouts.clear();
+    for (auto* layout : s_native_redeclared) {
+        layout->~NativeLayout();
+        ks_dealloc(layout);
+    }
+    s_native_redeclared.clear();
+
     s_script_component_types.clear();
     g_registered_observers.clear();
+    s_component_lookup.erase(world);
+
+    std::lock_guard<std::mutex> shared_lock(s_shared_mutex);
+    s_shared_refs.clear();
 }
 
 static void apply_components_from_table(Ks_Script_Ctx ctx, Ks_Ecs_World world, Ks_Entity entity, Ks_Script_Object list_obj) {
@@ -198,6 +608,409 @@ static ks_returns_count l_component_ctor(Ks_Script_Ctx ctx) {
 }
 
 
+enum ScriptSnapshotTag : ks_uint8 {
+    SCRIPT_SNAP_NIL,
+    SCRIPT_SNAP_FALSE,
+    SCRIPT_SNAP_TRUE,
+    SCRIPT_SNAP_INT,
+    SCRIPT_SNAP_NUMBER,
+    SCRIPT_SNAP_STRING,
+    SCRIPT_SNAP_TABLE,
+    SCRIPT_SNAP_END
+};
+
+static constexpr int KS_SCRIPT_SNAPSHOT_MAX_DEPTH = 32;
+
+static bool is_snapshot_value(Ks_Script_Ctx ctx, Ks_Script_Object v) {
+    switch (ks_script_obj_type(ctx, v)) {
+    case KS_TYPE_NIL:
+    case KS_TYPE_BOOL:
+    case KS_TYPE_INT:
+    case KS_TYPE_DOUBLE:
+    case KS_TYPE_CSTRING:
+    case KS_TYPE_SCRIPT_TABLE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void write_script_value(Ks_Script_Ctx ctx, Ks_Script_Object v, Ks_Ecs_Snapshot_Stream out, int depth) {
+    ks_uint8 tag = SCRIPT_SNAP_NIL;
+
+    switch (ks_script_obj_type(ctx, v)) {
+    case KS_TYPE_BOOL:
+        tag = ks_script_obj_as_boolean(ctx, v) ? SCRIPT_SNAP_TRUE : SCRIPT_SNAP_FALSE;
+        ks_ecs_snapshot_write(out, &tag, 1);
+        return;
+    case KS_TYPE_INT: {
+        tag = SCRIPT_SNAP_INT;
+        ks_int64 i = ks_script_obj_as_integer(ctx, v);
+        ks_ecs_snapshot_write(out, &tag, 1);
+        ks_ecs_snapshot_write(out, &i, sizeof(i));
+        return;
+    }
+    case KS_TYPE_DOUBLE: {
+        tag = SCRIPT_SNAP_NUMBER;
+        ks_double d = ks_script_obj_as_number(ctx, v);
+        ks_ecs_snapshot_write(out, &tag, 1);
+        ks_ecs_snapshot_write(out, &d, sizeof(d));
+        return;
+    }
+    case KS_TYPE_CSTRING: {
+        tag = SCRIPT_SNAP_STRING;
+        const char* str = ks_script_obj_as_string_view(ctx, v);
+        ks_uint32 len = str ? (ks_uint32)strlen(str) : 0;
+        ks_ecs_snapshot_write(out, &tag, 1);
+        ks_ecs_snapshot_write(out, &len, sizeof(len));
+        ks_ecs_snapshot_write(out, str, len);
+        return;
+    }
+    case KS_TYPE_SCRIPT_TABLE:
+        if (depth < KS_SCRIPT_SNAPSHOT_MAX_DEPTH) break;
+        KS_LOG_WARN("Lua ECS: Snapshot table nesting exceeds %d levels, truncating", KS_SCRIPT_SNAPSHOT_MAX_DEPTH);
+        ks_ecs_snapshot_write(out, &tag, 1);
+        return;
+    default:
+        ks_ecs_snapshot_write(out, &tag, 1);
+        return;
+    }
+
+    tag = SCRIPT_SNAP_TABLE;
+    ks_ecs_snapshot_write(out, &tag, 1);
+
+    Ks_Script_Table_Iterator it = ks_script_table_iterate(ctx, v);
+    while (ks_script_iterator_has_next(ctx, &it)) {
+        Ks_Script_Object key, val;
+        if (ks_script_iterator_next(ctx, &it, &key, &val) && is_snapshot_value(ctx, key) && is_snapshot_value(ctx, val)) {
+            write_script_value(ctx, key, out, depth + 1);
+            write_script_value(ctx, val, out, depth + 1);
+        }
+    }
+    ks_script_iterator_destroy(ctx, &it);
+
+    tag = SCRIPT_SNAP_END;
+    ks_ecs_snapshot_write(out, &tag, 1);
+}
+
+static bool read_script_value(Ks_Script_Ctx ctx, Ks_Ecs_Snapshot_Stream in, Ks_Script_Object* out, int depth, bool* end = nullptr) {
+    ks_uint8 tag = 0;
+    if (!ks_ecs_snapshot_read(in, &tag, 1)) return false;
+
+    switch (tag) {
+    case SCRIPT_SNAP_NIL:
+        *out = ks_script_create_nil(ctx);
+        return true;
+    case SCRIPT_SNAP_FALSE:
+    case SCRIPT_SNAP_TRUE:
+        *out = ks_script_create_boolean(ctx, tag == SCRIPT_SNAP_TRUE);
+        return true;
+    case SCRIPT_SNAP_INT: {
+        ks_int64 i = 0;
+        if (!ks_ecs_snapshot_read(in, &i, sizeof(i))) return false;
+        *out = ks_script_create_integer(ctx, i);
+        return true;
+    }
+    case SCRIPT_SNAP_NUMBER: {
+        ks_double d = 0;
+        if (!ks_ecs_snapshot_read(in, &d, sizeof(d))) return false;
+        *out = ks_script_create_number(ctx, d);
+        return true;
+    }
+    case SCRIPT_SNAP_STRING: {
+        ks_uint32 len = 0;
+        if (!ks_ecs_snapshot_read(in, &len, sizeof(len))) return false;
+        std::string str(len, '\0');
+        if (!ks_ecs_snapshot_read(in, str.data(), len)) return false;
+        *out = ks_script_create_lstring(ctx, str.data(), len);
+        return true;
+    }
+    case SCRIPT_SNAP_TABLE: {
+        if (depth >= KS_SCRIPT_SNAPSHOT_MAX_DEPTH) return false;
+        Ks_Script_Table tbl = ks_script_create_table(ctx);
+        for (;;) {
+            Ks_Script_Object key, val;
+            bool table_end = false;
+            if (!read_script_value(ctx, in, &key, depth + 1, &table_end)) return false;
+            if (table_end) break;
+            if (!read_script_value(ctx, in, &val, depth + 1)) return false;
+            ks_script_table_set(ctx, tbl, key, val);
+        }
+        *out = tbl;
+        return true;
+    }
+    case SCRIPT_SNAP_END:
+        if (!end) return false;
+        *end = true;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void script_snapshot_save(Ks_Ecs_World world, Ks_Component component, const void* column, ks_int32 count, Ks_Ecs_Snapshot_Stream out, void* user_data) {
+    Ks_Script_Ctx ctx = ((ScriptCleanupCtx*)user_data)->ctx;
+    const ScriptComponent* wrappers = (const ScriptComponent*)column;
+
+    for (ks_int32 i = 0; i < count; ++i) {
+        if (wrappers[i].ref == KS_SCRIPT_NO_REF) {
+            ks_uint8 tag = SCRIPT_SNAP_NIL;
+            ks_ecs_snapshot_write(out, &tag, 1);
+            continue;
+        }
+
+        Ks_Script_Object tbl;
+        tbl.type = KS_TYPE_SCRIPT_TABLE;
+        tbl.state = KS_SCRIPT_OBJECT_VALID;
+        tbl.val.table_ref = wrappers[i].ref;
+
+        ks_script_begin_scope(ctx);
+        write_script_value(ctx, tbl, out, 0);
+        ks_script_end_scope(ctx);
+    }
+}
+
+static void script_snapshot_discard(Ks_Ecs_World world, Ks_Component component, void* column, ks_int32 count, void* user_data) {
+    Ks_Script_Ctx ctx = ((ScriptCleanupCtx*)user_data)->ctx;
+    ScriptComponent* wrappers = (ScriptComponent*)column;
+
+    for (ks_int32 i = 0; i < count; ++i) {
+        if (wrappers[i].ref == KS_SCRIPT_NO_REF) continue;
+
+        Ks_Script_Object obj;
+        obj.type = KS_TYPE_SCRIPT_TABLE;
+        obj.state = KS_SCRIPT_OBJECT_VALID;
+        obj.val.table_ref = wrappers[i].ref;
+        ks_script_free_obj(ctx, obj);
+        wrappers[i].ref = KS_SCRIPT_NO_REF;
+    }
+}
+
+static bool script_snapshot_load(Ks_Ecs_World world, Ks_Component component, void* column, ks_int32 count, Ks_Ecs_Snapshot_Stream in, void* user_data) {
+    Ks_Script_Ctx ctx = ((ScriptCleanupCtx*)user_data)->ctx;
+    ScriptComponent* wrappers = (ScriptComponent*)column;
+
+    for (ks_int32 i = 0; i < count; ++i) {
+        wrappers[i].ref = KS_SCRIPT_NO_REF;
+
+        ks_script_begin_scope(ctx);
+        Ks_Script_Object value;
+        bool ok = read_script_value(ctx, in, &value, 0);
+        if (ok && ks_script_obj_type(ctx, value) == KS_TYPE_SCRIPT_TABLE) {
+            Ks_Script_Object ref_obj = ks_script_ref_obj(ctx, value);
+            ks_script_promote(ctx, ref_obj);
+            wrappers[i].ref = ref_obj.val.table_ref;
+        }
+        ks_script_end_scope(ctx);
+
+        if (!ok) {
+            script_snapshot_discard(world, component, column, i + 1, user_data);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool layout_field_type(const char* type_str, Ks_Type* type, ks_size* size) {
+    if (!type_str) return false;
+    if (strcmp(type_str, "int") == 0)    { *type = KS_TYPE_INT;    *size = sizeof(ks_int);    return true; }
+    if (strcmp(type_str, "float") == 0)  { *type = KS_TYPE_FLOAT;  *size = sizeof(ks_float);  return true; }
+    if (strcmp(type_str, "double") == 0) { *type = KS_TYPE_DOUBLE; *size = sizeof(ks_double); return true; }
+    if (strcmp(type_str, "bool") == 0)   { *type = KS_TYPE_BOOL;   *size = sizeof(ks_bool);   return true; }
+    return false;
+}
+
+static const char* layout_type_str(Ks_Type type) {
+    switch (type) {
+    case KS_TYPE_INT:    return "int";
+    case KS_TYPE_FLOAT:  return "float";
+    case KS_TYPE_DOUBLE: return "double";
+    default:             return "bool";
+    }
+}
+
+static void write_layout_fields(Ks_Script_Ctx ctx, const NativeLayout* layout, ks_byte* dst, Ks_Script_Object values) {
+    if (!ks_script_obj_is(ctx, values, KS_TYPE_SCRIPT_TABLE)) return;
+
+    ks_script_begin_scope(ctx);
+    for (const NativeLayoutField& f : layout->fields) {
+        Ks_Script_Object v = ks_script_table_get(ctx, values, ks_script_create_cstring(ctx, f.name.c_str()));
+        if (!ks_script_obj_is_valid(ctx, v)) continue;
+
+        ks_byte* field = dst + f.offset;
+        switch (f.type) {
+        case KS_TYPE_INT: {
+            ks_int x = (ks_int)ks_script_obj_as_integer_or(ctx, v, 0);
+            memcpy(field, &x, sizeof(x));
+        } break;
+        case KS_TYPE_FLOAT: {
+            ks_float x = (ks_float)ks_script_obj_as_number_or(ctx, v, 0.0);
+            memcpy(field, &x, sizeof(x));
+        } break;
+        case KS_TYPE_DOUBLE: {
+            ks_double x = ks_script_obj_as_number_or(ctx, v, 0.0);
+            memcpy(field, &x, sizeof(x));
+        } break;
+        case KS_TYPE_BOOL: {
+            ks_bool x = ks_script_obj_as_boolean_or(ctx, v, ks_false);
+            memcpy(field, &x, sizeof(x));
+        } break;
+        default: break;
+        }
+    }
+    ks_script_end_scope(ctx);
+}
+
+static ks_returns_count l_layout_ctor(Ks_Script_Ctx ctx) {
+    Ks_Script_Object upval = ks_script_get_upvalue(ctx, 1);
+    auto* layout = (const NativeLayout*)ks_script_lightuserdata_get_ptr(ctx, upval);
+
+    Ks_Script_Userdata ud = ks_script_create_usertype_instance(ctx, layout->type_name.c_str());
+    ks_byte* ptr = (ks_byte*)ks_script_usertype_get_ptr(ctx, ud);
+    if (!ptr) return 0;
+
+    memcpy(ptr, layout->defaults.data(), layout->size);
+    write_layout_fields(ctx, layout, ptr, ks_script_get_arg(ctx, 2));
+
+    ks_script_stack_push_obj(ctx, ud);
+    return 1;
+}
+
+// Fields are ordered by size, then name, so the layout is deterministic no
+// matter how Lua iterates the declaration and needs no inner padding.
+static NativeLayout* build_native_layout(Ks_Script_Ctx ctx, const char* name, Ks_Script_Object decl) {
+    void* mem = ks_alloc_debug(sizeof(NativeLayout), KS_LT_USER_MANAGED, KS_TAG_SCRIPT, "NativeLayout");
+    NativeLayout* layout = new(mem) NativeLayout();
+    layout->type_name = name;
+
+    std::vector<std::pair<NativeLayoutField, ks_size>> fields;
+    bool valid = true;
+
+    Ks_Script_Table_Iterator it = ks_script_table_iterate(ctx, decl);
+    while (ks_script_iterator_has_next(ctx, &it)) {
+        Ks_Script_Object key, val;
+        if (!ks_script_iterator_next(ctx, &it, &key, &val)) continue;
+
+        const char* field_name = ks_script_obj_as_cstring(ctx, key);
+        const char* type_str = ks_script_obj_as_cstring(ctx, val);
+        NativeLayoutField field = { field_name ? field_name : "", KS_TYPE_UNKNOWN, 0 };
+        ks_size size = 0;
+
+        if (!field_name || !layout_field_type(type_str, &field.type, &size)) {
+            KS_LOG_ERROR("Lua ECS: Component '%s' field '%s' needs one of int, float, double, bool", name, field_name ? field_name : "?");
+            valid = false;
+            continue;
+        }
+        fields.emplace_back(field, size);
+    }
+    ks_script_iterator_destroy(ctx, &it);
+
+    std::sort(fields.begin(), fields.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first.name < b.first.name;
+    });
+
+    ks_size offset = 0;
+    ks_size align = 1;
+    for (auto& [field, size] : fields) {
+        field.offset = offset;
+        offset += size;
+        align = std::max(align, size);
+        layout->fields.push_back(field);
+    }
+    layout->size = std::max<ks_size>((offset + align - 1) & ~(align - 1), 1);
+
+    const Ks_Type_Info* existing = ks_reflection_get_type(name);
+    if (valid && existing) {
+        valid = existing->size == layout->size && existing->field_count == layout->fields.size();
+        for (ks_size i = 0; valid && i < layout->fields.size(); ++i) {
+            valid = strcmp(existing->fields[i].name, layout->fields[i].name.c_str()) == 0 &&
+                    existing->fields[i].type == layout->fields[i].type;
+        }
+        if (!valid) KS_LOG_ERROR("Lua ECS: Component '%s' is already reflected with a different layout", name);
+    }
+
+    if (!valid || fields.empty()) {
+        layout->~NativeLayout();
+        ks_dealloc(layout);
+        return nullptr;
+    }
+
+    if (!existing) {
+        Ks_Reflection_Builder b = ks_reflection_builder_begin(name, KS_META_STRUCT, layout->size, align);
+        for (auto& [field, size] : fields) {
+            ks_reflection_builder_add_field(b, field.name.c_str(), layout_type_str(field.type), nullptr, field.offset, size);
+        }
+        ks_reflection_builder_end(b);
+    }
+
+    layout->defaults.assign(layout->size, 0);
+    return layout;
+}
+
+static bool same_native_layout(const NativeLayout* a, const NativeLayout* b) {
+    if (a->size != b->size || a->fields.size() != b->fields.size()) return false;
+    for (ks_size i = 0; i < a->fields.size(); ++i) {
+        const NativeLayoutField& fa = a->fields[i];
+        const NativeLayoutField& fb = b->fields[i];
+        if (fa.name != fb.name || fa.type != fb.type || fa.offset != fb.offset) return false;
+    }
+    return true;
+}
+
+// Layouts are shared by every script context, so a later declaration of the
+// same name must describe the same fields. It keeps its own defaults for its
+// constructor, and the usertype, which lives in each Lua state, is
+// registered for every context that declares the component.
+static ks_returns_count l_ecs_native_component(Ks_Script_Ctx ctx, Ks_Ecs_World world, const char* name, Ks_Script_Object defaults, Ks_Script_Object decl) {
+    NativeLayout* layout = build_native_layout(ctx, name, decl);
+    if (!layout) return 0;
+    write_layout_fields(ctx, layout, layout->defaults.data(), defaults);
+
+    {
+        std::lock_guard<std::mutex> lock(s_binding_mutex);
+        auto [found, inserted] = s_native_layouts.try_emplace(name, layout);
+        if (!inserted && same_native_layout(found->second, layout)) {
+            s_native_redeclared.push_back(layout);
+        } else if (!inserted) {
+            KS_LOG_ERROR("Lua ECS: Component '%s' is already declared with a different layout", name);
+            layout->~NativeLayout();
+            ks_dealloc(layout);
+            return 0;
+        }
+    }
+
+    Ks_Script_Usertype_Builder b = ks_script_usertype_begin_from_ref(ctx, name);
+    if (b) ks_script_usertype_end(b);
+
+    if (is_script_component(name)) {
+        KS_LOG_ERROR("Lua ECS: Component '%s' is already declared as a script component", name);
+        return 0;
+    }
+
+    // A name this world already used before the layout existed was registered
+    // as a plain int sized component; its column cannot hold the layout.
+    ks_size registered = ks_ecs_component_size(world, ks_ecs_component_id(world, name));
+    if (registered != layout->size) {
+        KS_LOG_ERROR("Lua ECS: Component '%s' is already registered with %zu bytes, its layout needs %zu", name, (size_t)registered, (size_t)layout->size);
+        return 0;
+    }
+
+    Ks_Script_Table cls = ks_script_create_table(ctx);
+    Ks_Script_Table mt = ks_script_create_table(ctx);
+
+    ks_script_stack_push_obj(ctx, ks_script_create_lightuserdata(ctx, layout));
+    Ks_Script_Sig_Def sig = { l_layout_ctor, nullptr, 0 };
+    Ks_Script_Function ctor = ks_script_create_cfunc_with_upvalues(ctx, &sig, 1, 1);
+
+    ks_script_table_set(ctx, mt, ks_script_create_cstring(ctx, "__call"), ctor);
+    ks_script_table_set(ctx, cls, ks_script_create_cstring(ctx, "_type"), ks_script_create_cstring(ctx, name));
+    ks_script_obj_set_metatable(ctx, cls, mt);
+
+    ks_script_set_global(ctx, name, cls);
+    ks_script_stack_push_obj(ctx, cls);
+    return 1;
+}
+
 static ks_returns_count l_ecs_Component(Ks_Script_Ctx ctx) {
     Ks_Script_Object upval = ks_script_get_upvalue(ctx, 1);
     Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, upval);
@@ -205,6 +1018,11 @@ static ks_returns_count l_ecs_Component(Ks_Script_Ctx ctx) {
     Ks_Script_Object name_obj = ks_script_get_arg(ctx, 1);
     const char* name = ks_script_obj_as_cstring(ctx, name_obj);
 
+    Ks_Script_Object layout_decl = ks_script_get_arg(ctx, 3);
+    if (name && ks_script_obj_is(ctx, layout_decl, KS_TYPE_SCRIPT_TABLE)) {
+        return l_ecs_native_component(ctx, world, name, ks_script_get_arg(ctx, 2), layout_decl);
+    }
+
     if (g_registered_observers.find(name) == g_registered_observers.end()) {
         ScriptCleanupCtx* clean_ctx = (ScriptCleanupCtx*)ks_alloc_debug(
             sizeof(ScriptCleanupCtx),
@@ -218,6 +1036,8 @@ static ks_returns_count l_ecs_Component(Ks_Script_Ctx ctx) {
 
         ks_ecs_create_observer(world, KS_EVENT_ON_REMOVE, name,
             on_script_component_remove, clean_ctx);
+        ks_ecs_set_snapshot_hooks(world, ks_ecs_component_id(world, name),
+            script_snapshot_save, script_snapshot_load, script_snapshot_discard, clean_ctx);
 
         g_registered_observers.insert(name);
         s_cleanup_contexts.push_back(clean_ctx);
@@ -266,6 +1086,22 @@ static void push_entity_handle(Ks_Script_Ctx ctx, Ks_Ecs_World w, Ks_Entity id)
     ks_script_stack_push_obj(ctx, ud);
 }
 
+static void push_entity_range(Ks_Script_Ctx ctx, Ks_Ecs_World w, Ks_Entity_Range range) {
+    Ks_Script_Table result = ks_script_create_table_with_capacity(ctx, (ks_size)range.count, 0);
+    for (ks_int32 e = 0; e < range.count; ++e) {
+        ks_script_begin_scope(ctx);
+        Ks_Script_Userdata ud = ks_script_create_usertype_instance(ctx, "EntityHandle");
+        EntityHandle* handle = (EntityHandle*)ks_script_usertype_get_ptr(ctx, ud);
+        handle->world = w;
+        handle->id = range.entities[e];
+
+        ks_script_table_set(ctx, result, ks_script_create_integer(ctx, (ks_int64)e + 1), ud);
+        ks_script_end_scope(ctx);
+    }
+
+    ks_script_stack_push_obj(ctx, result);
+}
+
 static ks_returns_count l_ecs_Entity(Ks_Script_Ctx ctx) {
     Ks_Script_Object upval = ks_script_get_upvalue(ctx, 1);
     Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, upval);
@@ -283,6 +1119,19 @@ static ks_returns_count l_ecs_Entity(Ks_Script_Ctx ctx) {
     return 1;
 }
 
+static void share_prefab_script_components(Ks_Script_Ctx ctx, Ks_Ecs_World world, Ks_Entity prefab) {
+    std::lock_guard<std::mutex> lock(s_binding_mutex);
+    for (const auto& type_name : s_script_component_types) {
+        if (!ks_ecs_has_component(world, prefab, type_name.c_str())) continue;
+
+        auto* wrapper = (const ScriptComponent*)ks_ecs_get_component(world, prefab, type_name.c_str());
+        if (!wrapper || wrapper->ref == KS_SCRIPT_NO_REF) continue;
+
+        std::lock_guard<std::mutex> shared_lock(s_shared_mutex);
+        s_shared_refs[ctx].insert(wrapper->ref);
+    }
+}
+
 static ks_returns_count l_ecs_Prefab(Ks_Script_Ctx ctx) {
     Ks_Script_Object upval = ks_script_get_upvalue(ctx, 1);
     Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, upval);
@@ -294,12 +1143,114 @@ static ks_returns_count l_ecs_Prefab(Ks_Script_Ctx ctx) {
 
     if (ks_script_obj_is(ctx, components, KS_TYPE_SCRIPT_TABLE)) {
         apply_components_from_table(ctx, world, e, components);
+        share_prefab_script_components(ctx, world, e);
     }
 
     push_entity_handle(ctx, world, e);
     return 1;
 }
 
+static ks_returns_count l_ecs_Entities(Ks_Script_Ctx ctx) {
+    Ks_Script_Object upval = ks_script_get_upvalue(ctx, 1);
+    Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, upval);
+
+    ks_int64 count = ks_script_obj_as_integer_or(ctx, ks_script_get_arg(ctx, 1), 0);
+    Ks_Script_Object list_obj = ks_script_get_arg(ctx, 2);
+
+    if (count <= 0) {
+        ks_script_stack_push_obj(ctx, ks_script_create_table(ctx));
+        return 1;
+    }
+
+    std::vector<Ks_Component> ids;
+    std::vector<std::vector<ks_byte>> columns;
+    std::vector<int> script_refs;
+
+    if (ks_script_obj_is(ctx, list_obj, KS_TYPE_SCRIPT_TABLE)) {
+        ks_size len = ks_script_table_array_size(ctx, list_obj);
+
+        for (ks_size i = 1; i <= len; ++i) {
+            ks_script_begin_scope(ctx);
+            Ks_Script_Object index = ks_script_create_integer(ctx, (ks_int64)i);
+            Ks_Script_Object item = ks_script_table_get(ctx, list_obj, index);
+
+            if (ks_script_obj_is(ctx, item, KS_TYPE_USERDATA)) {
+                ks_str type_name = ks_script_obj_get_usertype_name(ctx, item);
+                void* ptr = ks_script_usertype_get_ptr(ctx, item);
+                ComponentLookup comp = type_name ? lookup_component(world, type_name) : ComponentLookup{};
+
+                if (ptr && comp.id && comp.info) {
+                    std::vector<ks_byte> column(comp.info->size * (ks_size)count);
+                    for (ks_int64 e = 0; e < count; ++e) {
+                        memcpy(column.data() + e * comp.info->size, ptr, comp.info->size);
+                    }
+                    ids.push_back(comp.id);
+                    columns.push_back(std::move(column));
+                    script_refs.push_back(KS_SCRIPT_NO_REF);
+                }
+                else {
+                    KS_LOG_WARN("Lua ECS: Invalid UserData component passed in definition");
+                }
+            }
+            else if (ks_script_obj_is(ctx, item, KS_TYPE_SCRIPT_TABLE)) {
+                Ks_Script_Object key_type = ks_script_create_cstring(ctx, "_type");
+                Ks_Script_Object val_type = ks_script_table_get(ctx, item, key_type);
+
+                if (ks_script_obj_is_valid(ctx, val_type)) {
+                    ks_str type_name = ks_script_obj_as_cstring(ctx, val_type);
+                    Ks_Script_Object ref_obj = ks_script_ref_obj(ctx, item);
+                    ks_script_promote(ctx, ref_obj);
+
+                    ids.push_back(lookup_component(world, type_name).id);
+                    columns.emplace_back(sizeof(ScriptComponent) * (ks_size)count);
+                    script_refs.push_back(ref_obj.val.table_ref);
+                }
+                else {
+                    KS_LOG_WARN("Lua ECS: Table in definition missing '_type'");
+                }
+            }
+            ks_script_end_scope(ctx);
+        }
+    }
+
+    for (ks_size c = 0; c < ids.size(); ++c) {
+        if (script_refs[c] == KS_SCRIPT_NO_REF) continue;
+
+        ScriptComponent* wrappers = (ScriptComponent*)columns[c].data();
+        wrappers[0].ref = script_refs[c];
+        for (ks_int64 e = 1; e < count; ++e) {
+            wrappers[e].ref = clone_script_component_data(ctx, script_refs[c]);
+        }
+    }
+
+    std::vector<const void*> data(ids.size());
+    for (ks_size c = 0; c < ids.size(); ++c) {
+        data[c] = columns[c].data();
+    }
+
+    Ks_Entity_Range range = ks_ecs_create_entities(world, (ks_int32)count, ids.data(), (ks_int32)ids.size(), data.data());
+
+    // Nothing was created, so the cloned tables have no entity to release them.
+    if (range.count == 0) {
+        for (ks_size c = 0; c < ids.size(); ++c) {
+            if (script_refs[c] == KS_SCRIPT_NO_REF) continue;
+
+            const ScriptComponent* wrappers = (const ScriptComponent*)columns[c].data();
+            for (ks_int64 e = 0; e < count; ++e) {
+                if (wrappers[e].ref == KS_SCRIPT_NO_REF) continue;
+                Ks_Script_Object obj;
+                obj.type = KS_TYPE_SCRIPT_TABLE;
+                obj.state = KS_SCRIPT_OBJECT_VALID;
+                obj.val.table_ref = wrappers[e].ref;
+                ks_script_free_obj(ctx, obj);
+            }
+        }
+    }
+
+    push_entity_range(ctx, world, range);
+    return 1;
+}
+
 static ks_returns_count l_ecs_create_instance(Ks_Script_Ctx ctx) {
     Ks_Script_Object upval = ks_script_get_upvalue(ctx, 1);
     Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, upval);
@@ -316,28 +1267,17 @@ static ks_returns_count l_ecs_create_instance(Ks_Script_Ctx ctx) {
     }
 
     if (prefab_id) {
-        Ks_Entity inst = ks_ecs_instantiate(world, prefab_id);
-
-        {
-            std::vector<std::string> types_to_check;
-            {
-                std::lock_guard<std::mutex> lock(s_binding_mutex);
-                types_to_check = s_script_component_types;
-            }
-
-            for (const auto& type_name : types_to_check) {
-                if (ks_ecs_has_component(world, inst, type_name.c_str())) {
-                    ScriptComponent* data = (ScriptComponent*)ks_ecs_get_component_mut(world, inst, type_name.c_str());
-
-                    if (data && data->ref != KS_SCRIPT_NO_REF) {
-                        int new_ref = clone_script_component_data(ctx, data->ref);
-                        data->ref = new_ref;
-                    }
-                }
-            }
+        // Script tables are cloned on first access through an instance, so
+        // spawning costs the same whether the prefab carries them or not.
+        share_prefab_script_components(ctx, world, prefab_id);
+
+        ks_int64 count = ks_script_obj_as_integer_or(ctx, ks_script_get_arg(ctx, 2), 0);
+        if (count > 0) {
+            push_entity_range(ctx, world, ks_ecs_instantiate_n(world, prefab_id, (ks_int32)count, nullptr));
+            return 1;
         }
 
-        push_entity_handle(ctx, world, inst);
+        push_entity_handle(ctx, world, ks_ecs_instantiate(world, prefab_id));
         return 1;
     }
 
@@ -354,7 +1294,10 @@ static ks_returns_count l_entity_add(Ks_Script_Ctx ctx) {
         ks_str type = ks_script_obj_get_usertype_name(ctx, item);
         KS_LOG_INFO("type = %s", type);
         void* ptr = ks_script_usertype_get_ptr(ctx, item);
-        if (type && ptr) ks_ecs_set_component(ent->world, ent->id, type, ptr);
+        if (type && ptr) {
+            ComponentLookup comp = lookup_component(ent->world, type);
+            ks_ecs_set_component_by_id(ent->world, ent->id, comp.id, ptr);
+        }
     }
     else if (ks_script_obj_is(ctx, item, KS_TYPE_SCRIPT_TABLE)) {
         Ks_Script_Object key_type = ks_script_create_cstring(ctx, "_type");
@@ -368,7 +1311,8 @@ static ks_returns_count l_entity_add(Ks_Script_Ctx ctx) {
             ScriptComponent wrapper;
             wrapper.ref = ref_obj.val.table_ref;
 
-            ks_ecs_set_component(ent->world, ent->id, type, &wrapper);
+            ComponentLookup comp = lookup_component(ent->world, type);
+            ks_ecs_set_component_by_id(ent->world, ent->id, comp.id, &wrapper);
         }
     }
     Ks_Script_Object self = ks_script_create_usertype_ref(ctx, "EntityHandle", ent);
@@ -383,15 +1327,15 @@ static ks_returns_count l_entity_get(Ks_Script_Ctx ctx) {
     Ks_Script_Object name_obj = ks_script_get_arg(ctx, 1);
     const char* type_name = ks_script_obj_as_cstring(ctx, name_obj);
 
-    void* ptr = ks_ecs_get_component_mut(ent->world, ent->id, type_name);
+    ComponentLookup comp = lookup_component(ent->world, type_name);
+    void* ptr = ks_ecs_get_component_mut_by_id(ent->world, ent->id, comp.id);
 
     if (!ptr) {
         ks_script_stack_push_obj(ctx, ks_script_create_nil(ctx));
         return 1;
     }
 
-    const Ks_Type_Info* info = ks_reflection_get_type(type_name);
-    if (info) {
+    if (comp.info) {
         Ks_Script_Object ref = ks_script_create_usertype_ref(ctx, type_name, ptr);
         ks_script_stack_push_obj(ctx, ref);
     }
@@ -401,19 +1345,36 @@ static ks_returns_count l_entity_get(Ks_Script_Ctx ctx) {
         Ks_Script_Object tbl;
         tbl.type = KS_TYPE_SCRIPT_TABLE;
         tbl.state = KS_SCRIPT_OBJECT_VALID;
-        tbl.val.table_ref = wrapper->ref;
+        tbl.val.table_ref = ks_ecs_is_prefab(ent->world, ent->id) ? wrapper->ref : own_script_component(ctx, wrapper);
 
         ks_script_stack_push_obj(ctx, tbl);
     }
     return 1;
 }
 
+static ks_returns_count l_entity_modified(Ks_Script_Ctx ctx) {
+    EntityHandle* ent = (EntityHandle*)ks_script_get_self(ctx);
+
+    const char* type_name = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 1));
+    ComponentLookup comp = lookup_component(ent->world, type_name);
+    if (ks_ecs_has_component_by_id(ent->world, ent->id, comp.id)) {
+        ks_ecs_modified_by_id(ent->world, ent->id, comp.id);
+    }
+    return 0;
+}
+
+static ks_returns_count l_entity_get_mut(Ks_Script_Ctx ctx) {
+    l_entity_modified(ctx);
+    return l_entity_get(ctx);
+}
+
 static ks_returns_count l_entity_has(Ks_Script_Ctx ctx) {
     EntityHandle* ent = (EntityHandle*)ks_script_get_self(ctx);
 
     const char* type_name = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 1));
 
-    ks_bool has = ks_ecs_has_component(ent->world, ent->id, type_name);
+    ComponentLookup comp = lookup_component(ent->world, type_name);
+    ks_bool has = ks_ecs_has_component_by_id(ent->world, ent->id, comp.id);
     ks_script_stack_push_boolean(ctx, has);
     return 1;
 }
@@ -428,16 +1389,7 @@ static ks_returns_count l_entity_destroy(Ks_Script_Ctx ctx) {
             for (const auto& type_name : s_script_component_types) {
                 if (ks_ecs_has_component(ent->world, ent->id, type_name.c_str())) {
                     ScriptComponent* data = (ScriptComponent*)ks_ecs_get_component_mut(ent->world, ent->id, type_name.c_str());
-
-                    if (data && data->ref != KS_SCRIPT_NO_REF) {
-                        Ks_Script_Object obj;
-                        obj.type = KS_TYPE_SCRIPT_TABLE;
-                        obj.state = KS_SCRIPT_OBJECT_VALID;
-                        obj.val.table_ref = data->ref;
-
-                        ks_script_free_obj(ctx, obj);
-                        data->ref = KS_SCRIPT_NO_REF;
-                    }
+                    if (data) release_script_component(ctx, ent->world, ent->id, type_name.c_str(), data);
                 }
             }
         }
@@ -526,6 +1478,48 @@ static int l_ecs_system(Ks_Script_Ctx ctx) {
     return 0;
 }
 
+static int l_ecs_batch_system(Ks_Script_Ctx ctx) {
+    const char* name = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 1));
+    const char* phase_name = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 2));
+    const char* signature = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 3));
+    Ks_Script_Function callback = ks_script_obj_as_function(ctx, ks_script_get_arg(ctx, 4));
+
+    Ks_Script_Object world_ud = ks_script_func_get_upvalue(ctx, 1);
+    Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, static_cast<Ks_Script_LightUserdata>(world_ud));
+
+    if (!world || !name || callback.state == KS_SCRIPT_OBJECT_INVALID) return 0;
+
+    ks_int32 field_count = ks_ecs_filter_field_count(world, signature);
+    if (field_count < 0) {
+        KS_LOG_WARN("Lua ECS: Batch system '%s' has an invalid signature", name);
+        return 0;
+    }
+    if (field_count > KS_LUA_BATCH_MAX_FIELDS) {
+        KS_LOG_WARN("Lua ECS: Batch system '%s' has %d fields, max is %d", name, field_count, KS_LUA_BATCH_MAX_FIELDS);
+        return 0;
+    }
+
+    void* mem = ks_alloc_debug(sizeof(LuaBatchCtx), KS_LT_USER_MANAGED, KS_TAG_SCRIPT, "LuaBatchCtx");
+    LuaBatchCtx* batch = new(mem) LuaBatchCtx();
+    batch->ctx = ctx;
+    batch->function_ref = ks_script_ref_obj(ctx, callback).val.function_ref;
+    batch->field_count = field_count;
+
+    for (ks_int32 i = 0; i <= field_count; ++i) {
+        batch->views[i] = ks_script_create_usertype_instance(ctx, "EcsColumnView");
+        batch->view_ptrs[i] = (EcsColumnView*)ks_script_usertype_get_ptr(ctx, batch->views[i]);
+        *batch->view_ptrs[i] = { nullptr, 0, 0, i == 0 ? ECS_COLUMN_ENTITY : ECS_COLUMN_NONE, nullptr, batch };
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_binding_mutex);
+        s_batch_contexts.push_back(batch);
+    }
+
+    ks_ecs_create_system_iter(world, name, signature, get_phase_entity(phase_name), lua_ecs_batch_thunk, batch);
+    return 0;
+}
+
 static int l_ecs_observer(Ks_Script_Ctx ctx) {
     const char* evt_name = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 1));
     const char* signature = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 2));
@@ -553,28 +1547,168 @@ static int l_ecs_observer(Ks_Script_Ctx ctx) {
     return 0;
 }
 
-static int l_ecs_query(Ks_Script_Ctx ctx) {
-    const char* signature = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 1));
-    Ks_Script_Function callback = ks_script_obj_as_function(ctx, ks_script_get_arg(ctx, 2));
-
-    Ks_Script_Object world_ud = ks_script_func_get_upvalue(ctx, 1);
-    Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, static_cast<Ks_Script_LightUserdata>(world_ud));
+static Ks_Ecs_Query get_cached_query(Ks_Ecs_World world, const char* signature) {
+    auto& cache = s_query_cache[world];
+    auto it = cache.find(std::string_view(signature));
+    if (it != cache.end()) return it->second;
 
-    if (!world || !signature || callback.state == KS_SCRIPT_OBJECT_INVALID) return 0;
+    Ks_Ecs_Query query = ks_ecs_query_create(world, signature);
+    if (query) cache.emplace(signature, query);
+    return query;
+}
 
+static void run_lua_query(Ks_Script_Ctx ctx, Ks_Ecs_Query query, Ks_Script_Function callback) {
     LuaCallbackCtx cb_ctx;
     cb_ctx.ctx = ctx;
 
     Ks_Script_Object ref_obj = ks_script_ref_obj(ctx, callback);
     cb_ctx.function_ref = ref_obj.val.function_ref;
 
-    ks_ecs_run_query(world, signature, lua_ecs_callback_thunk, &cb_ctx);
+    ks_ecs_query_each(query, lua_ecs_callback_thunk, &cb_ctx);
 
     ks_script_free_obj(ctx, ref_obj);
+}
+
+static void l_query_gc(ks_ptr data, ks_size size) {
+    auto* handle = (LuaQueryHandle*)data;
+    if (s_lua_queries.erase(handle) > 0 && handle->query) {
+        ks_ecs_query_destroy(handle->query);
+    }
+    handle->query = nullptr;
+}
+
+static ks_returns_count l_query_each(Ks_Script_Ctx ctx) {
+    auto* handle = (LuaQueryHandle*)ks_script_get_self(ctx);
+    Ks_Script_Function callback = ks_script_obj_as_function(ctx, ks_script_get_arg(ctx, 1));
+
+    if (!handle || !handle->query || callback.state == KS_SCRIPT_OBJECT_INVALID) return 0;
+
+    run_lua_query(ctx, handle->query, callback);
     return 0;
 }
 
+static ks_returns_count l_query_destroy(Ks_Script_Ctx ctx) {
+    auto* handle = (LuaQueryHandle*)ks_script_get_self(ctx);
+    if (handle) l_query_gc(handle, sizeof(LuaQueryHandle));
+    return 0;
+}
+
+static int l_ecs_query(Ks_Script_Ctx ctx) {
+    const char* signature = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 1));
+
+    Ks_Script_Object world_ud = ks_script_func_get_upvalue(ctx, 1);
+    Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, static_cast<Ks_Script_LightUserdata>(world_ud));
+
+    if (!world || !signature) return 0;
+
+    Ks_Script_Object callback_arg = ks_script_get_arg(ctx, 2);
+
+    if (!ks_script_obj_is(ctx, callback_arg, KS_TYPE_SCRIPT_FUNCTION)) {
+        Ks_Ecs_Query query = ks_ecs_query_create(world, signature);
+        if (!query) return 0;
+
+        Ks_Script_Userdata ud = ks_script_create_usertype_instance(ctx, "EcsQuery");
+        auto* handle = (LuaQueryHandle*)ks_script_usertype_get_ptr(ctx, ud);
+        handle->world = world;
+        handle->query = query;
+        s_lua_queries.insert(handle);
+
+        ks_script_stack_push_obj(ctx, ud);
+        return 1;
+    }
+
+    Ks_Script_Function callback = ks_script_obj_as_function(ctx, callback_arg);
+    if (callback.state == KS_SCRIPT_OBJECT_INVALID) return 0;
+
+    Ks_Ecs_Query query = get_cached_query(world, signature);
+    if (!query) return 0;
+
+    run_lua_query(ctx, query, callback);
+    return 0;
+}
+
+static void l_spatial_gc(ks_ptr data, ks_size size) {
+    auto* handle = (LuaSpatialHandle*)data;
+    if (handle->index && s_lua_spatial.erase(handle->index) > 0) {
+        ks_ecs_spatial_destroy(handle->index);
+    }
+    handle->index = nullptr;
+}
+
+static ks_float number_arg(Ks_Script_Ctx ctx, int index) {
+    return (ks_float)ks_script_obj_as_number_or(ctx, ks_script_get_arg(ctx, index), 0.0);
+}
+
+static ks_returns_count l_spatial_radius(Ks_Script_Ctx ctx) {
+    auto* handle = (LuaSpatialHandle*)ks_script_get_self(ctx);
+    if (!handle || !handle->index) return 0;
+
+    Ks_Entity_Range range = ks_ecs_spatial_query_radius(handle->index,
+        number_arg(ctx, 1), number_arg(ctx, 2), number_arg(ctx, 3), number_arg(ctx, 4));
+    push_entity_range(ctx, handle->world, range);
+    return 1;
+}
+
+static ks_returns_count l_spatial_aabb(Ks_Script_Ctx ctx) {
+    auto* handle = (LuaSpatialHandle*)ks_script_get_self(ctx);
+    if (!handle || !handle->index) return 0;
+
+    Ks_Entity_Range range = ks_ecs_spatial_query_aabb(handle->index,
+        number_arg(ctx, 1), number_arg(ctx, 2), number_arg(ctx, 3),
+        number_arg(ctx, 4), number_arg(ctx, 5), number_arg(ctx, 6));
+    push_entity_range(ctx, handle->world, range);
+    return 1;
+}
+
+static ks_returns_count l_spatial_nearest(Ks_Script_Ctx ctx) {
+    auto* handle = (LuaSpatialHandle*)ks_script_get_self(ctx);
+    if (!handle || !handle->index) return 0;
+
+    ks_int64 k = ks_script_obj_as_integer_or(ctx, ks_script_get_arg(ctx, 4), 1);
+    Ks_Entity_Range range = ks_ecs_spatial_query_nearest(handle->index,
+        number_arg(ctx, 1), number_arg(ctx, 2), number_arg(ctx, 3), (ks_int32)k);
+    push_entity_range(ctx, handle->world, range);
+    return 1;
+}
+
+static ks_returns_count l_spatial_count(Ks_Script_Ctx ctx) {
+    auto* handle = (LuaSpatialHandle*)ks_script_get_self(ctx);
+    ks_script_stack_push_integer(ctx, handle ? ks_ecs_spatial_count(handle->index) : 0);
+    return 1;
+}
+
+static ks_returns_count l_spatial_destroy(Ks_Script_Ctx ctx) {
+    auto* handle = (LuaSpatialHandle*)ks_script_get_self(ctx);
+    if (handle) l_spatial_gc(handle, sizeof(LuaSpatialHandle));
+    return 0;
+}
+
+static int l_ecs_spatial(Ks_Script_Ctx ctx) {
+    Ks_Script_Object upval = ks_script_get_upvalue(ctx, 1);
+    Ks_Ecs_World world = (Ks_Ecs_World)ks_script_lightuserdata_get_ptr(ctx, upval);
+
+    const char* type_name = ks_script_obj_as_cstring(ctx, ks_script_get_arg(ctx, 1));
+    ks_float cell_size = (ks_float)ks_script_obj_as_number_or(ctx, ks_script_get_arg(ctx, 2), 1.0);
+
+    if (!world || !type_name) return 0;
+
+    Ks_Ecs_Spatial index = ks_ecs_spatial_create(world, type_name, cell_size);
+    if (!index) return 0;
+
+    s_lua_spatial.insert(index);
+
+    Ks_Script_Userdata ud = ks_script_create_usertype_instance(ctx, "EcsSpatial");
+    auto* handle = (LuaSpatialHandle*)ks_script_usertype_get_ptr(ctx, ud);
+    handle->world = world;
+    handle->index = index;
+
+    ks_script_stack_push_obj(ctx, ud);
+    return 1;
+}
+
 KS_API ks_no_ret ks_ecs_lua_bind(Ks_Ecs_World world, Ks_Script_Ctx ctx) {
+    ks_ecs_on_destroy(world, on_world_destroy, nullptr);
+
     Ks_Script_Usertype_Builder b = ks_script_usertype_begin(ctx, "EntityHandle", sizeof(EntityHandle));
 
     ks_script_usertype_add_method(b, "add", KS_SCRIPT_OVERLOAD(
@@ -583,6 +1717,8 @@ KS_API ks_no_ret ks_ecs_lua_bind(Ks_Ecs_World world, Ks_Script_Ctx ctx) {
     ));
 
     ks_script_usertype_add_method(b, "get", KS_SCRIPT_FUNC(l_entity_get, KS_TYPE_CSTRING));
+    ks_script_usertype_add_method(b, "get_mut", KS_SCRIPT_FUNC(l_entity_get_mut, KS_TYPE_CSTRING));
+    ks_script_usertype_add_method(b, "modified", KS_SCRIPT_FUNC(l_entity_modified, KS_TYPE_CSTRING));
     ks_script_usertype_add_method(b, "has", KS_SCRIPT_FUNC(l_entity_has, KS_TYPE_CSTRING));
     ks_script_usertype_add_method(b, "destroy", KS_SCRIPT_FUNC_VOID(l_entity_destroy));
 
@@ -592,6 +1728,33 @@ KS_API ks_no_ret ks_ecs_lua_bind(Ks_Ecs_World world, Ks_Script_Ctx ctx) {
 
     ks_script_usertype_end(b);
 
+    Ks_Script_Usertype_Builder qb = ks_script_usertype_begin(ctx, "EcsQuery", sizeof(LuaQueryHandle));
+    ks_script_usertype_set_destructor(qb, l_query_gc);
+    ks_script_usertype_add_method(qb, "each", KS_SCRIPT_FUNC(l_query_each, KS_TYPE_SCRIPT_FUNCTION));
+    ks_script_usertype_add_method(qb, "destroy", KS_SCRIPT_FUNC_VOID(l_query_destroy));
+    ks_script_usertype_end(qb);
+
+    Ks_Script_Usertype_Builder sb = ks_script_usertype_begin(ctx, "EcsSpatial", sizeof(LuaSpatialHandle));
+    ks_script_usertype_set_destructor(sb, l_spatial_gc);
+    ks_script_usertype_add_method(sb, "radius", KS_SCRIPT_FUNC(l_spatial_radius, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE));
+    ks_script_usertype_add_method(sb, "aabb", KS_SCRIPT_FUNC(l_spatial_aabb, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE));
+    ks_script_usertype_add_method(sb, "nearest", KS_SCRIPT_FUNC(l_spatial_nearest, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_DOUBLE, KS_TYPE_INT));
+    ks_script_usertype_add_method(sb, "count", KS_SCRIPT_FUNC_VOID(l_spatial_count));
+    ks_script_usertype_add_method(sb, "destroy", KS_SCRIPT_FUNC_VOID(l_spatial_destroy));
+    ks_script_usertype_end(sb);
+
+    Ks_Script_Usertype_Builder vb = ks_script_usertype_begin(ctx, "EcsColumnView", sizeof(EcsColumnView));
+    ks_script_usertype_add_metamethod(vb, KS_SCRIPT_MT_INDEX, KS_SCRIPT_OVERLOAD(
+        KS_SCRIPT_SIG_DEF(l_column_view_index, KS_TYPE_USERDATA, KS_TYPE_INT),
+        KS_SCRIPT_SIG_DEF(l_column_view_field, KS_TYPE_USERDATA, KS_TYPE_CSTRING)
+    ));
+    ks_script_usertype_end(vb);
+
+    Ks_Script_Usertype_Builder fb = ks_script_usertype_begin(ctx, "EcsFieldView", sizeof(EcsFieldView));
+    ks_script_usertype_add_metamethod(fb, KS_SCRIPT_MT_INDEX, KS_SCRIPT_FUNC(l_field_view_index, KS_TYPE_USERDATA, KS_TYPE_INT));
+    ks_script_usertype_add_metamethod(fb, KS_SCRIPT_MT_NEWINDEX, KS_SCRIPT_FUNC(l_field_view_newindex, KS_TYPE_USERDATA, KS_TYPE_INT, KS_TYPE_SCRIPT_ANY));
+    ks_script_usertype_end(fb);
+
     Ks_Script_Table ecs_table = ks_script_create_named_table(ctx, "ecs");
 
     auto register_ecs_func = [&](const char* name, ks_script_cfunc f) {
@@ -604,9 +1767,12 @@ KS_API ks_no_ret ks_ecs_lua_bind(Ks_Ecs_World world, Ks_Script_Ctx ctx) {
 
     register_ecs_func("Entity", l_ecs_Entity);
     register_ecs_func("Prefab", l_ecs_Prefab);
+    register_ecs_func("Entities", l_ecs_Entities);
     register_ecs_func("Component", l_ecs_Component);
     register_ecs_func("instantiate", l_ecs_create_instance);
     register_ecs_func("System", l_ecs_system);
+    register_ecs_func("BatchSystem", l_ecs_batch_system);
     register_ecs_func("Observer", l_ecs_observer);
     register_ecs_func("Query", l_ecs_query);
+    register_ecs_func("Spatial", l_ecs_spatial);
 }
\ No newline at end of file
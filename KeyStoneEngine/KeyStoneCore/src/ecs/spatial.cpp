@@ -0,0 +1,369 @@
+#include "../include/ecs/spatial.h"
+#include "../include/core/reflection.h"
+#include "../include/core/error.h"
+#include "../include/memory/memory.h"
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <utility>
+#include <math.h>
+#include <string.h>
+
+enum SpatialErrors {
+    SPATIAL_CREATION_FAIL
+};
+
+// Cell coordinates are packed into 21 bits per axis, so the grid spans
+// +-2^20 cells in every direction before positions start to clamp.
+static constexpr ks_int32 KS_SPATIAL_CELL_LIMIT = 1 << 20;
+static constexpr ks_uint64 KS_SPATIAL_CELL_MASK = (1ull << 21) - 1;
+
+struct SpatialAxis {
+    ks_size offset;
+    Ks_Type type;
+    bool present;
+};
+
+struct SpatialEntry {
+    Ks_Entity entity;
+    ks_uint64 cell;
+    ks_uint32 cell_index;
+    ks_float pos[3];
+};
+
+struct Ks_Ecs_Spatial_Impl {
+    Ks_Ecs_World world;
+    Ks_Component component;
+    SpatialAxis axes[3];
+    ks_float cell_size;
+    ks_float inv_cell_size;
+
+    // Entries are kept dense so queries and swaps stay cache friendly; cells
+    // hold indices into it and every entry remembers its position in its cell.
+    std::vector<SpatialEntry> entries;
+    std::unordered_map<Ks_Entity, ks_uint32> entry_of;
+    std::unordered_map<ks_uint64, std::vector<ks_uint32>> cells;
+
+    Ks_Entity on_set;
+    Ks_Entity on_remove;
+    Ks_Entity sync_system;
+
+    std::vector<Ks_Entity> results;
+    std::vector<std::pair<ks_float, Ks_Entity>> candidates;
+};
+
+static Ks_Ecs_Spatial_Impl* get(Ks_Ecs_Spatial index) {
+    return static_cast<Ks_Ecs_Spatial_Impl*>(index);
+}
+
+static ks_int32 cell_coord(const Ks_Ecs_Spatial_Impl* s, ks_float v) {
+    ks_float c = floorf(v * s->inv_cell_size);
+    if (!(c > -(ks_float)KS_SPATIAL_CELL_LIMIT)) return -KS_SPATIAL_CELL_LIMIT;
+    if (c >= (ks_float)(KS_SPATIAL_CELL_LIMIT - 1)) return KS_SPATIAL_CELL_LIMIT - 1;
+    return (ks_int32)c;
+}
+
+static ks_uint64 cell_key(ks_int32 x, ks_int32 y, ks_int32 z) {
+    return (((ks_uint64)x & KS_SPATIAL_CELL_MASK) << 42) |
+           (((ks_uint64)y & KS_SPATIAL_CELL_MASK) << 21) |
+           ((ks_uint64)z & KS_SPATIAL_CELL_MASK);
+}
+
+static ks_uint64 cell_of(const Ks_Ecs_Spatial_Impl* s, const ks_float pos[3]) {
+    return cell_key(cell_coord(s, pos[0]), cell_coord(s, pos[1]), cell_coord(s, pos[2]));
+}
+
+static void read_position(const Ks_Ecs_Spatial_Impl* s, const void* data, ks_float out[3]) {
+    const ks_byte* bytes = (const ks_byte*)data;
+    for (int a = 0; a < 3; ++a) {
+        const SpatialAxis& axis = s->axes[a];
+        if (!axis.present) {
+            out[a] = 0.0f;
+        }
+        else if (axis.type == KS_TYPE_DOUBLE) {
+            ks_double v;
+            memcpy(&v, bytes + axis.offset, sizeof(v));
+            out[a] = (ks_float)v;
+        }
+        else {
+            memcpy(&out[a], bytes + axis.offset, sizeof(ks_float));
+        }
+    }
+}
+
+static void cell_insert(Ks_Ecs_Spatial_Impl* s, ks_uint32 slot) {
+    SpatialEntry& entry = s->entries[slot];
+    std::vector<ks_uint32>& cell = s->cells[entry.cell];
+    entry.cell_index = (ks_uint32)cell.size();
+    cell.push_back(slot);
+}
+
+// Empty cells are dropped right away so the occupied-cell walk in
+// for_each_in_box never visits cells that entities have moved out of.
+static void cell_erase(Ks_Ecs_Spatial_Impl* s, ks_uint32 slot) {
+    SpatialEntry& entry = s->entries[slot];
+    auto found = s->cells.find(entry.cell);
+    if (found == s->cells.end()) return;
+
+    std::vector<ks_uint32>& cell = found->second;
+    ks_uint32 last = cell.back();
+    cell[entry.cell_index] = last;
+    s->entries[last].cell_index = entry.cell_index;
+    cell.pop_back();
+    if (cell.empty()) s->cells.erase(found);
+}
+
+static void spatial_upsert(Ks_Ecs_Spatial_Impl* s, Ks_Entity entity, const void* data) {
+    ks_float pos[3];
+    read_position(s, data, pos);
+    ks_uint64 cell = cell_of(s, pos);
+
+    auto found = s->entry_of.find(entity);
+    if (found == s->entry_of.end()) {
+        ks_uint32 slot = (ks_uint32)s->entries.size();
+        s->entries.push_back({ entity, cell, 0, { pos[0], pos[1], pos[2] } });
+        s->entry_of.emplace(entity, slot);
+        cell_insert(s, slot);
+        return;
+    }
+
+    ks_uint32 slot = found->second;
+    SpatialEntry& entry = s->entries[slot];
+    memcpy(entry.pos, pos, sizeof(pos));
+    if (entry.cell != cell) {
+        cell_erase(s, slot);
+        entry.cell = cell;
+        cell_insert(s, slot);
+    }
+}
+
+static void spatial_erase(Ks_Ecs_Spatial_Impl* s, Ks_Entity entity) {
+    auto found = s->entry_of.find(entity);
+    if (found == s->entry_of.end()) return;
+
+    ks_uint32 slot = found->second;
+    ks_uint32 last = (ks_uint32)s->entries.size() - 1;
+    cell_erase(s, slot);
+    s->entry_of.erase(found);
+
+    if (slot != last) {
+        SpatialEntry& moved = s->entries[last];
+        s->cells[moved.cell][moved.cell_index] = slot;
+        s->entry_of[moved.entity] = slot;
+        s->entries[slot] = moved;
+    }
+    s->entries.pop_back();
+}
+
+static void on_position_set(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
+    auto* s = static_cast<Ks_Ecs_Spatial_Impl*>(user_data);
+    const void* data = ks_ecs_get_component_by_id(world, entity, s->component);
+    if (data) spatial_upsert(s, entity, data);
+}
+
+static void on_position_remove(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
+    spatial_erase(static_cast<Ks_Ecs_Spatial_Impl*>(user_data), entity);
+}
+
+// Systems that write positions in place never emit OnSet, so tables whose
+// position column changed this frame are re-binned after the update phase.
+static void sync_moved(Ks_Ecs_Iter* it) {
+    auto* s = static_cast<Ks_Ecs_Spatial_Impl*>(it->user_data);
+    const ks_byte* base = (const ks_byte*)ks_ecs_iter_field(it, 0);
+    if (!base) return;
+
+    ks_size stride = ks_ecs_iter_field_is_self(it, 0) ? ks_ecs_iter_field_size(it, 0) : 0;
+    for (ks_int32 i = 0; i < it->count; ++i) {
+        spatial_upsert(s, it->entities[i], base + stride * i);
+    }
+}
+
+template<typename F>
+static void for_each_in_box(Ks_Ecs_Spatial_Impl* s, const ks_float lo[3], const ks_float hi[3], F&& visit) {
+    ks_int32 c0[3], c1[3];
+    ks_double span = 1.0;
+    for (int a = 0; a < 3; ++a) {
+        c0[a] = cell_coord(s, lo[a]);
+        c1[a] = cell_coord(s, hi[a]);
+        span *= (ks_double)(c1[a] - c0[a] + 1);
+    }
+
+    // Large ranges over a sparse grid are cheaper to answer by walking the
+    // occupied cells than by probing every coordinate in the box.
+    if (span > (ks_double)s->cells.size()) {
+        for (auto& [key, cell] : s->cells) {
+            for (ks_uint32 slot : cell) visit(s->entries[slot]);
+        }
+        return;
+    }
+
+    for (ks_int32 x = c0[0]; x <= c1[0]; ++x) {
+        for (ks_int32 y = c0[1]; y <= c1[1]; ++y) {
+            for (ks_int32 z = c0[2]; z <= c1[2]; ++z) {
+                auto found = s->cells.find(cell_key(x, y, z));
+                if (found == s->cells.end()) continue;
+                for (ks_uint32 slot : found->second) visit(s->entries[slot]);
+            }
+        }
+    }
+}
+
+static void gather_radius(Ks_Ecs_Spatial_Impl* s, const ks_float center[3], ks_float radius) {
+    ks_float lo[3], hi[3];
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = center[a] - radius;
+        hi[a] = center[a] + radius;
+    }
+
+    ks_float r2 = radius * radius;
+    s->candidates.clear();
+    for_each_in_box(s, lo, hi, [&](const SpatialEntry& e) {
+        ks_float dx = e.pos[0] - center[0];
+        ks_float dy = e.pos[1] - center[1];
+        ks_float dz = e.pos[2] - center[2];
+        ks_float d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 <= r2) s->candidates.emplace_back(d2, e.entity);
+    });
+}
+
+// The world tears down its observers and systems itself; the index just
+// forgets it and stays valid, empty, until ks_ecs_spatial_destroy.
+static void on_world_destroy(Ks_Ecs_World world, void* user_data) {
+    auto* s = static_cast<Ks_Ecs_Spatial_Impl*>(user_data);
+    s->world = nullptr;
+    s->on_set = 0;
+    s->on_remove = 0;
+    s->sync_system = 0;
+    s->entries.clear();
+    s->entry_of.clear();
+    s->cells.clear();
+}
+
+static Ks_Entity_Range make_range(const std::vector<Ks_Entity>& results) {
+    Ks_Entity_Range range = { results.data(), (ks_int32)results.size() };
+    return range;
+}
+
+Ks_Ecs_Spatial ks_ecs_spatial_create(Ks_Ecs_World world, const char* position_type, ks_float cell_size) {
+    if (!world || !position_type) return nullptr;
+
+    const Ks_Type_Info* info = ks_reflection_get_type(position_type);
+    if (!info || !(cell_size > 0.0f)) {
+        ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", SpatialErrors::SPATIAL_CREATION_FAIL, "Invalid spatial index on '%s'", position_type);
+        return nullptr;
+    }
+
+    SpatialAxis axes[3] = {};
+    const char* names[3] = { "x", "y", "z" };
+    for (ks_size f = 0; f < info->field_count; ++f) {
+        const Ks_Field_Info& field = info->fields[f];
+        if (field.type != KS_TYPE_FLOAT && field.type != KS_TYPE_DOUBLE) continue;
+        if (field.ptr_depth != 0 || field.is_array) continue;
+
+        for (int a = 0; a < 3; ++a) {
+            if (strcmp(field.name, names[a]) == 0) axes[a] = { field.offset, field.type, true };
+        }
+    }
+
+    if (!axes[0].present || !axes[1].present) {
+        ks_epush_s_fmt(KS_ERROR_LEVEL_BASE, "ECS", SpatialErrors::SPATIAL_CREATION_FAIL, "Type '%s' needs float 'x' and 'y' fields to be spatially indexed", position_type);
+        return nullptr;
+    }
+
+    void* mem = ks_alloc_debug(sizeof(Ks_Ecs_Spatial_Impl), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEcsSpatial");
+    Ks_Ecs_Spatial_Impl* s = new(mem) Ks_Ecs_Spatial_Impl();
+    s->world = world;
+    s->component = ks_ecs_component_id(world, position_type);
+    memcpy(s->axes, axes, sizeof(axes));
+    s->cell_size = cell_size;
+    s->inv_cell_size = 1.0f / cell_size;
+
+    s->on_set = ks_ecs_create_observer(world, KS_EVENT_ON_SET, position_type, on_position_set, s);
+    s->on_remove = ks_ecs_create_observer(world, KS_EVENT_ON_REMOVE, position_type, on_position_remove, s);
+
+    std::string filter = std::string("[in] ") + position_type;
+    s->sync_system = ks_ecs_create_system_changed(world, nullptr, filter.c_str(), KS_PHASE_POST_UPDATE, sync_moved, s);
+
+    ks_ecs_on_destroy(world, on_world_destroy, s);
+    return s;
+}
+
+void ks_ecs_spatial_destroy(Ks_Ecs_Spatial index) {
+    if (!index) return;
+    Ks_Ecs_Spatial_Impl* s = get(index);
+
+    if (s->world) {
+        ks_ecs_remove_on_destroy(s->world, on_world_destroy, s);
+        if (s->on_set) ks_ecs_destroy_entity(s->world, s->on_set);
+        if (s->on_remove) ks_ecs_destroy_entity(s->world, s->on_remove);
+        if (s->sync_system) ks_ecs_destroy_entity(s->world, s->sync_system);
+    }
+
+    s->~Ks_Ecs_Spatial_Impl();
+    ks_dealloc(s);
+}
+
+ks_int32 ks_ecs_spatial_count(Ks_Ecs_Spatial index) {
+    if (!index) return 0;
+    return (ks_int32)get(index)->entries.size();
+}
+
+Ks_Entity_Range ks_ecs_spatial_query_radius(Ks_Ecs_Spatial index, ks_float x, ks_float y, ks_float z, ks_float radius) {
+    Ks_Entity_Range range = { nullptr, 0 };
+    if (!index || radius < 0.0f) return range;
+    Ks_Ecs_Spatial_Impl* s = get(index);
+
+    ks_float center[3] = { x, y, s->axes[2].present ? z : 0.0f };
+    gather_radius(s, center, radius);
+
+    s->results.clear();
+    for (auto& [d2, e] : s->candidates) s->results.push_back(e);
+    return make_range(s->results);
+}
+
+Ks_Entity_Range ks_ecs_spatial_query_aabb(Ks_Ecs_Spatial index, ks_float min_x, ks_float min_y, ks_float min_z, ks_float max_x, ks_float max_y, ks_float max_z) {
+    Ks_Entity_Range range = { nullptr, 0 };
+    if (!index) return range;
+    Ks_Ecs_Spatial_Impl* s = get(index);
+
+    bool has_z = s->axes[2].present;
+    ks_float lo[3] = { min_x, min_y, has_z ? min_z : 0.0f };
+    ks_float hi[3] = { max_x, max_y, has_z ? max_z : 0.0f };
+
+    s->results.clear();
+    for_each_in_box(s, lo, hi, [&](const SpatialEntry& e) {
+        for (int a = 0; a < 3; ++a) {
+            if (e.pos[a] < lo[a] || e.pos[a] > hi[a]) return;
+        }
+        s->results.push_back(e.entity);
+    });
+    return make_range(s->results);
+}
+
+Ks_Entity_Range ks_ecs_spatial_query_nearest(Ks_Ecs_Spatial index, ks_float x, ks_float y, ks_float z, ks_int32 k) {
+    Ks_Entity_Range range = { nullptr, 0 };
+    if (!index || k <= 0) return range;
+    Ks_Ecs_Spatial_Impl* s = get(index);
+
+    ks_float center[3] = { x, y, s->axes[2].present ? z : 0.0f };
+    ks_size want = std::min((ks_size)k, s->entries.size());
+
+    // Every entry inside the search sphere is collected, so once it holds k
+    // candidates the k closest of them are the k nearest overall.
+    ks_float radius = s->cell_size;
+    for (;;) {
+        gather_radius(s, center, radius);
+        if (s->candidates.size() >= want || !isfinite(radius)) break;
+        radius *= 2.0f;
+    }
+
+    want = std::min(want, s->candidates.size());
+    std::partial_sort(s->candidates.begin(), s->candidates.begin() + want, s->candidates.end(),
+        [](const std::pair<ks_float, Ks_Entity>& a, const std::pair<ks_float, Ks_Entity>& b) { return a.first < b.first; });
+
+    s->results.clear();
+    for (ks_size i = 0; i < want; ++i) s->results.push_back(s->candidates[i].second);
+    return make_range(s->results);
+}
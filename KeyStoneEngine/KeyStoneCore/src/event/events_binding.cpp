@@ -6,20 +6,63 @@
 #include "../../include/profiler/profiler.h"
 #include "../../include/memory/memory.h"
 #include <unordered_map>
+#include <vector>
 #include <string>
+#include <algorithm>
 #include <string.h>
 
 #define BINDING_HANDLE_MASK 0x00FFFFFF
 
 static std::vector<Ks_Script_Object> g_lua_layouts_by_id;
 
+struct PackedEventField {
+    Ks_Script_Object key;
+    Ks_Type type;
+    ks_size offset;
+};
+
+// A Lua layout whose fields are all numbers or booleans is compiled once at
+// registration into a reflected struct named after the event. Payload tables
+// are marshalled straight into that struct through cached key refs, so C++
+// subscribers read fields at fixed offsets and publish never walks the layout.
+struct PackedEventLayout {
+    ks_size size = 0;
+    std::vector<PackedEventField> fields;
+};
+
+static std::vector<PackedEventLayout> g_packed_layouts_by_id;
+
+// Largest payload marshalled on the stack; bigger layouts use the heap.
+#define KS_PACKED_EVENT_INLINE_SIZE 256
+
 struct LuaSubInfo {
     Ks_Script_Ctx ctx;
     Ks_Script_Object func;
     bool is_lua_wrapper;
     const Ks_Type_Info* native_info;
+    Ks_Script_Object view;
+    ks_uint32 depth;
+};
+
+// A packed publish from Lua remembers the table it marshalled, so Lua
+// subscribers of that publish receive the table itself rather than a view of
+// the packed copy. Frames nest with re-entrant publishes.
+struct LuaPublishFrame {
+    Ks_Script_Ctx ctx;
+    const void* data;
+    Ks_Script_Object payload;
+    const LuaPublishFrame* prev;
 };
 
+static thread_local const LuaPublishFrame* s_lua_publish = nullptr;
+
+static const LuaPublishFrame* find_publish_frame(Ks_Script_Ctx ctx, const void* data) {
+    for (const LuaPublishFrame* f = s_lua_publish; f; f = f->prev) {
+        if (f->data == data) return f->ctx == ctx ? f : nullptr;
+    }
+    return nullptr;
+}
+
 void ks_register_lua_event_reflection(void) {
     if (!ks_reflection_get_type("ScriptEvent")) {
         ks_reflect_struct(ScriptEvent,
@@ -30,38 +73,154 @@ void ks_register_lua_event_reflection(void) {
     }
 }
 
-static bool validate_payload(Ks_Script_Ctx ctx, Ks_Script_Object layout, Ks_Script_Object payload) {
-    int lay_type = ks_script_obj_type(ctx, layout);
-    int pay_type = ks_script_obj_type(ctx, payload);
+static const PackedEventLayout* packed_layout(uint32_t idx) {
+    if (idx >= g_packed_layouts_by_id.size() || g_packed_layouts_by_id[idx].size == 0) return nullptr;
+    return &g_packed_layouts_by_id[idx];
+}
 
-    if (lay_type == KS_TYPE_NIL || lay_type == KS_TYPE_UNKNOWN) {
-        if (pay_type != KS_TYPE_NIL && pay_type != KS_TYPE_UNKNOWN) {
-            KS_LOG_ERROR("[Events] Signal expects no payload.");
-            return false;
-        }
-        return true;
+static bool is_script_wrapped(uint32_t idx) {
+    return idx < g_lua_layouts_by_id.size() && g_lua_layouts_by_id[idx].type != KS_TYPE_NIL && !packed_layout(idx);
+}
+
+static bool packed_field_type(ks_int64 type, ks_size* size, const char** type_str) {
+    switch (type) {
+    case KS_TYPE_INT:    *size = sizeof(ks_int);    *type_str = "int";    return true;
+    case KS_TYPE_FLOAT:  *size = sizeof(ks_float);  *type_str = "float";  return true;
+    case KS_TYPE_DOUBLE: *size = sizeof(ks_double); *type_str = "double"; return true;
+    case KS_TYPE_BOOL:   *size = sizeof(ks_bool);   *type_str = "bool";   return true;
+    default: return false;
     }
+}
 
-    if (pay_type != KS_TYPE_SCRIPT_TABLE && pay_type != KS_TYPE_USERDATA) return false;
+// Fields are ordered by size, then name, so the layout does not depend on
+// table iteration order. Returns false for layouts that stay table-backed.
+static bool compile_packed_layout(Ks_Script_Ctx ctx, const char* name, Ks_Script_Object layout, PackedEventLayout* out) {
+    struct FieldDecl { std::string name; Ks_Type type; ks_size size; const char* type_str; };
+    std::vector<FieldDecl> decls;
+    bool packable = ks_script_obj_type(ctx, layout) == KS_TYPE_SCRIPT_TABLE;
 
+    ks_script_begin_scope(ctx);
     Ks_Script_Table_Iterator it = ks_script_table_iterate(ctx, layout);
     Ks_Script_Object key_obj, type_obj;
-    bool valid = true;
+    while (packable && ks_script_iterator_next(ctx, &it, &key_obj, &type_obj)) {
+        FieldDecl decl = { "", KS_TYPE_UNKNOWN, 0, nullptr };
+        const char* field_name = key_obj.type == KS_TYPE_CSTRING ? ks_script_obj_as_string_view(ctx, key_obj) : nullptr;
+        ks_int64 type = type_obj.type == KS_TYPE_INT ? ks_script_obj_as_integer(ctx, type_obj) : KS_TYPE_UNKNOWN;
+
+        packable = field_name && packed_field_type(type, &decl.size, &decl.type_str);
+        decl.name = field_name ? field_name : "";
+        decl.type = (Ks_Type)type;
+        decls.push_back(decl);
+    }
+    ks_script_iterator_destroy(ctx, &it);
+    ks_script_end_scope(ctx);
 
-    while (ks_script_iterator_next(ctx, &it, &key_obj, &type_obj)) {
-        Ks_Script_Object val = ks_script_table_get(ctx, payload, key_obj);
-        int exp = (int)ks_script_obj_as_integer(ctx, type_obj);
-        int act = ks_script_obj_type(ctx, val);
+    if (!packable || decls.empty()) return false;
 
-        if (exp != act) {
-            bool nums = (exp == KS_TYPE_INT || exp == KS_TYPE_FLOAT) && (act == KS_TYPE_INT || act == KS_TYPE_FLOAT);
-            if (!nums) { valid = false; break; }
+    std::sort(decls.begin(), decls.end(), [](const FieldDecl& a, const FieldDecl& b) {
+        return a.size != b.size ? a.size > b.size : a.name < b.name;
+    });
+
+    ks_size offset = 0;
+    ks_size align = 1;
+    for (const FieldDecl& d : decls) {
+        out->fields.push_back({ Ks_Script_Object{}, d.type, offset });
+        offset += d.size;
+        align = std::max(align, d.size);
+    }
+    out->size = (offset + align - 1) & ~(align - 1);
+
+    const Ks_Type_Info* existing = ks_reflection_get_type(name);
+    if (existing) {
+        bool same = existing->kind == KS_META_STRUCT && existing->size == out->size && existing->field_count == decls.size();
+        for (ks_size i = 0; same && i < decls.size(); ++i) {
+            same = strcmp(existing->fields[i].name, decls[i].name.c_str()) == 0 &&
+                   existing->fields[i].offset == out->fields[i].offset &&
+                   existing->fields[i].type == decls[i].type;
+        }
+        if (!same) {
+            KS_LOG_WARN("[Events] '%s' is already reflected with another layout; payloads stay table-backed.", name);
+            *out = PackedEventLayout();
+            return false;
         }
     }
-    ks_script_iterator_destroy(ctx, &it);
-    return valid;
+    else {
+        Ks_Reflection_Builder b = ks_reflection_builder_begin(name, KS_META_STRUCT, out->size, align);
+        for (ks_size i = 0; i < decls.size(); ++i) {
+            ks_reflection_builder_add_field(b, decls[i].name.c_str(), decls[i].type_str, nullptr, out->fields[i].offset, decls[i].size);
+        }
+        ks_reflection_builder_end(b);
+    }
+
+    ks_script_begin_scope(ctx);
+    for (ks_size i = 0; i < decls.size(); ++i) {
+        out->fields[i].key = ks_script_ref_obj(ctx, ks_script_create_cstring(ctx, decls[i].name.c_str()));
+        ks_script_promote(ctx, out->fields[i].key);
+    }
+    ks_script_end_scope(ctx);
+
+    Ks_Script_Usertype_Builder ub = ks_script_usertype_begin_from_ref(ctx, name);
+    if (ub) ks_script_usertype_end(ub);
+    return true;
 }
 
+// Validates and marshals a payload in one pass. Integer and float fields
+// accept any Lua number; a usertype instance of the event is copied as is.
+static bool marshal_payload(Ks_Script_Ctx ctx, const PackedEventLayout* layout, Ks_Script_Object payload, ks_byte* dst) {
+    if (payload.type == KS_TYPE_USERDATA) {
+        const void* src = ks_script_usertype_get_ptr(ctx, payload);
+        if (src) memcpy(dst, src, layout->size);
+        return src != nullptr;
+    }
+    if (payload.type != KS_TYPE_SCRIPT_TABLE) return false;
+
+    memset(dst, 0, layout->size);
+    for (const PackedEventField& f : layout->fields) {
+        Ks_Script_Object v = ks_script_table_get(ctx, payload, f.key);
+        bool is_num = v.type == KS_TYPE_INT || v.type == KS_TYPE_DOUBLE;
+        ks_double num = v.type == KS_TYPE_INT ? (ks_double)v.val.integer : v.val.number;
+
+        switch (f.type) {
+        case KS_TYPE_INT: {
+            // Packed and usertype int fields are 32-bit; wider values are
+            // rejected instead of being truncated.
+            if (!is_num || num < (ks_double)INT32_MIN || num > (ks_double)INT32_MAX) return false;
+            if (v.type == KS_TYPE_INT && (v.val.integer < INT32_MIN || v.val.integer > INT32_MAX)) return false;
+            ks_int x = v.type == KS_TYPE_INT ? (ks_int)v.val.integer : (ks_int)num;
+            memcpy(dst + f.offset, &x, sizeof(x));
+        } break;
+        case KS_TYPE_FLOAT: {
+            if (!is_num) return false;
+            ks_float x = (ks_float)num;
+            memcpy(dst + f.offset, &x, sizeof(x));
+        } break;
+        case KS_TYPE_DOUBLE: {
+            if (!is_num) return false;
+            memcpy(dst + f.offset, &num, sizeof(num));
+        } break;
+        case KS_TYPE_BOOL: {
+            if (v.type != KS_TYPE_BOOL) return false;
+            ks_bool x = v.val.boolean;
+            memcpy(dst + f.offset, &x, sizeof(x));
+        } break;
+        default: return false;
+        }
+    }
+    return true;
+}
+
+// Marshal target that stays on the stack for the usual small layouts.
+class PackedPayload {
+public:
+    explicit PackedPayload(ks_size size) {
+        if (size > KS_PACKED_EVENT_INLINE_SIZE) m_heap.resize(size);
+    }
+    ks_byte* data() { return m_heap.empty() ? m_inline : m_heap.data(); }
+private:
+    alignas(8) ks_byte m_inline[KS_PACKED_EVENT_INLINE_SIZE];
+    std::vector<ks_byte> m_heap;
+};
+
 static void lua_event_bridge(Ks_EventData data, void* user_data) {
     KS_PROFILE_SCOPE("ScriptEventBridge");
     LuaSubInfo* info = (LuaSubInfo*)user_data;
@@ -73,6 +232,18 @@ static void lua_event_bridge(Ks_EventData data, void* user_data) {
             ks_script_stack_push_obj(info->ctx, w->payload);
             args = 1;
         }
+        else if (const LuaPublishFrame* frame = info->view.type == KS_TYPE_USERDATA ? find_publish_frame(info->ctx, data) : nullptr) {
+            ks_script_stack_push_obj(info->ctx, frame->payload);
+            args = 1;
+        }
+        else if (info->view.type == KS_TYPE_USERDATA && info->depth == 0) {
+            void* ptr = ks_script_usertype_get_ptr(info->ctx, info->view);
+            if (ptr) {
+                memcpy(ptr, data, info->native_info->size);
+                ks_script_stack_push_obj(info->ctx, info->view);
+                args = 1;
+            }
+        }
         else if (info->native_info) {
             KS_PROFILE_SCOPE("NativeUserdataCreate");
             Ks_Script_Object ud = ks_script_create_usertype_instance(info->ctx, info->native_info->name);
@@ -94,7 +265,11 @@ static void lua_event_bridge(Ks_EventData data, void* user_data) {
     }
     {
         KS_PROFILE_SCOPE("LuaPCall");
+        // A nested publish of the same event gets its own userdata so it
+        // cannot overwrite the view an outer callback is still reading.
+        info->depth++;
         ks_script_func_call(info->ctx, info->func, args, 0);
+        info->depth--;
     }
 }
 
@@ -102,58 +277,107 @@ static void cleanup_sub_info(void* user_data) {
     LuaSubInfo* info = (LuaSubInfo*)user_data;
     if (info) {
         ks_script_free_obj(info->ctx, info->func);
+        if (info->view.type == KS_TYPE_USERDATA) ks_script_free_obj(info->ctx, info->view);
         ks_dealloc(info);
     }
 }
 
-ks_returns_count events_register_lua(Ks_Script_Ctx ctx) {
+// Queued script events hold a registry ref to their payload table until
+// dispatch is done with them, or coalescing replaces them.
+static void release_script_event(Ks_EventData data, void* user_data) {
+    const ScriptEvent* w = (const ScriptEvent*)data;
+    ks_script_free_obj((Ks_Script_Ctx)user_data, w->payload);
+}
+
+static void release_layout(Ks_Script_Ctx ctx, uint32_t idx) {
+    if (idx >= g_lua_layouts_by_id.size()) return;
+    ks_script_free_obj(ctx, g_lua_layouts_by_id[idx]);
+    for (const PackedEventField& f : g_packed_layouts_by_id[idx].fields) ks_script_free_obj(ctx, f.key);
+    g_lua_layouts_by_id[idx] = Ks_Script_Object{ KS_TYPE_NIL };
+    g_packed_layouts_by_id[idx] = PackedEventLayout();
+}
+
+// opts = { coalesce = "latest" | "per_key" }
+static Ks_Event_Coalesce parse_coalesce(Ks_Script_Ctx ctx, Ks_Script_Object opts) {
+    if (ks_script_obj_type(ctx, opts) != KS_TYPE_SCRIPT_TABLE) return KS_EVENT_COALESCE_NONE;
+
+    Ks_Script_Object mode = ks_script_table_get(ctx, opts, ks_script_create_cstring(ctx, "coalesce"));
+    const char* str = ks_script_obj_as_string_view(ctx, mode);
+    if (!str) return KS_EVENT_COALESCE_NONE;
+    if (strcmp(str, "latest") == 0) return KS_EVENT_COALESCE_LATEST;
+    if (strcmp(str, "per_key") == 0) return KS_EVENT_COALESCE_LATEST_PER_KEY;
+
+    KS_LOG_WARN("[Events] Unknown coalesce mode '%s', events will not be coalesced.", str);
+    return KS_EVENT_COALESCE_NONE;
+}
+
+static ks_returns_count register_script_event(Ks_Script_Ctx ctx, Ks_Script_Object layout, Ks_Script_Object opts) {
     Ks_Script_Object up = ks_script_func_get_upvalue(ctx, 1);
     Ks_EventManager em = (Ks_EventManager)ks_script_lightuserdata_get_ptr(ctx, up);
 
     const char* name = ks_script_obj_as_string_view(ctx, ks_script_get_arg(ctx, 1));
     if (!name) { ks_script_stack_push_obj(ctx, ks_script_create_integer(ctx, (ks_int64)KS_INVALID_HANDLE)); return 1; }
 
-    Ks_Script_Object layout = ks_script_get_arg(ctx, 2);
+    Ks_Event_Coalesce coalesce = parse_coalesce(ctx, opts);
     Ks_Handle h = KS_INVALID_HANDLE;
+    bool is_lua = ks_script_obj_type(ctx, layout) != KS_TYPE_NIL;
+    PackedEventLayout packed;
+    bool is_packed = is_lua && compile_packed_layout(ctx, name, layout, &packed);
 
-    if (ks_script_obj_type(ctx, layout) != KS_TYPE_NIL) {
+    if (is_packed) {
+        h = ks_event_manager_register_type_ex(em, name, coalesce);
+    }
+    else if (is_lua) {
         ks_reflection_register_typedef("ScriptEvent", name);
-        h = ks_event_manager_register_type(em, name);
+        h = ks_event_manager_register_type_ex(em, name, coalesce);
     }
     else {
-        h = ks_event_manager_register_signal(em, name);
+        h = ks_event_manager_register_signal_ex(em, name, coalesce);
     }
 
     if (h == KS_INVALID_HANDLE) { ks_script_stack_push_obj(ctx, ks_script_create_integer(ctx, (ks_int64)KS_INVALID_HANDLE)); return 1; }
 
+    if (is_lua && !is_packed) ks_event_manager_set_queued_release(em, h, release_script_event, ctx);
+
     uint32_t idx = (uint32_t)(h & BINDING_HANDLE_MASK);
 
     if (idx >= g_lua_layouts_by_id.size()) {
         g_lua_layouts_by_id.resize(idx + 16, { KS_TYPE_NIL });
+        g_packed_layouts_by_id.resize(idx + 16);
     }
 
+    release_layout(ctx, idx);
     g_lua_layouts_by_id[idx] = ks_script_ref_obj(ctx, layout);
+    g_packed_layouts_by_id[idx] = std::move(packed);
 
     ks_script_stack_push_integer(ctx, (ks_int64)h);
     return 1;
 }
 
-ks_returns_count events_publish_lua(Ks_Script_Ctx ctx) {
-    KS_PROFILE_SCOPE("EventsPublishLua");
-    Ks_Script_Object up = ks_script_func_get_upvalue(ctx, 1);
-    Ks_EventManager em = (Ks_EventManager)ks_script_lightuserdata_get_ptr(ctx, up);
+ks_returns_count events_register_lua(Ks_Script_Ctx ctx) {
+    return register_script_event(ctx, ks_script_get_arg(ctx, 2), ks_script_get_arg(ctx, 3));
+}
 
-    Ks_Script_Object arg1 = ks_script_get_arg(ctx, 1);
-    Ks_Handle h = KS_INVALID_HANDLE;
+ks_returns_count events_register_signal_lua(Ks_Script_Ctx ctx) {
+    return register_script_event(ctx, Ks_Script_Object{ KS_TYPE_NIL }, ks_script_get_arg(ctx, 2));
+}
 
-    if (arg1.type == KS_TYPE_INT || arg1.type == KS_TYPE_FLOAT) {
-        h = (Ks_Handle)ks_script_obj_as_integer(ctx, arg1);
+static Ks_Handle resolve_event_handle(Ks_Script_Ctx ctx, Ks_EventManager em, Ks_Script_Object arg) {
+    if (arg.type == KS_TYPE_INT || arg.type == KS_TYPE_FLOAT) {
+        return (Ks_Handle)ks_script_obj_as_integer(ctx, arg);
     }
-    else if (arg1.type == KS_TYPE_CSTRING) {
-        const char* name = ks_script_obj_as_string_view(ctx, arg1);
-        h = ks_event_manager_get_event_handle(em, name);
+    if (arg.type == KS_TYPE_CSTRING) {
+        return ks_event_manager_get_event_handle(em, ks_script_obj_as_string_view(ctx, arg));
     }
+    return KS_INVALID_HANDLE;
+}
 
+ks_returns_count events_publish_lua(Ks_Script_Ctx ctx) {
+    KS_PROFILE_SCOPE("EventsPublishLua");
+    Ks_Script_Object up = ks_script_func_get_upvalue(ctx, 1);
+    Ks_EventManager em = (Ks_EventManager)ks_script_lightuserdata_get_ptr(ctx, up);
+
+    Ks_Handle h = resolve_event_handle(ctx, em, ks_script_get_arg(ctx, 1));
     if (h == KS_INVALID_HANDLE) return 0;
 
     Ks_Script_Object payload = ks_script_get_arg(ctx, 2);
@@ -161,7 +385,21 @@ ks_returns_count events_publish_lua(Ks_Script_Ctx ctx) {
     uint32_t idx = (uint32_t)(h & BINDING_HANDLE_MASK);
     Ks_Script_Object layout = (idx < g_lua_layouts_by_id.size()) ? g_lua_layouts_by_id[idx] : Ks_Script_Object{ KS_TYPE_NIL };
 
-    if (ks_script_obj_type(ctx, payload) == KS_TYPE_NIL) {
+    if (const PackedEventLayout* packed = packed_layout(idx)) {
+        PackedPayload buf(packed->size);
+        if (!marshal_payload(ctx, packed, payload, buf.data())) {
+            KS_LOG_ERROR("[Events] Payload for '%s' does not match its layout.", ks_event_manager_get_event_name(em, h));
+            return 0;
+        }
+        LuaPublishFrame frame = { ctx, buf.data(), payload, s_lua_publish };
+        s_lua_publish = payload.type == KS_TYPE_SCRIPT_TABLE ? &frame : s_lua_publish;
+        {
+            KS_PROFILE_SCOPE("ManagerDispatch");
+            ks_event_manager_publish(em, h, buf.data());
+        }
+        s_lua_publish = frame.prev;
+    }
+    else if (ks_script_obj_type(ctx, payload) == KS_TYPE_NIL) {
         ks_event_manager_emit(em, h);
     }
     else {
@@ -177,6 +415,70 @@ ks_returns_count events_publish_lua(Ks_Script_Ctx ctx) {
     return 0;
 }
 
+// events.enqueue(event, payload [, key]): deferred until events.dispatch(),
+// collapsing to the latest payload for events registered with `coalesce`.
+ks_returns_count events_enqueue_lua(Ks_Script_Ctx ctx) {
+    KS_PROFILE_SCOPE("EventsEnqueueLua");
+    Ks_Script_Object up = ks_script_func_get_upvalue(ctx, 1);
+    Ks_EventManager em = (Ks_EventManager)ks_script_lightuserdata_get_ptr(ctx, up);
+
+    Ks_Handle h = resolve_event_handle(ctx, em, ks_script_get_arg(ctx, 1));
+    if (h == KS_INVALID_HANDLE) return 0;
+
+    Ks_Script_Object payload = ks_script_get_arg(ctx, 2);
+    Ks_Script_Object key_obj = ks_script_get_arg(ctx, 3);
+    bool keyed = key_obj.type == KS_TYPE_INT || key_obj.type == KS_TYPE_FLOAT;
+    ks_uint64 key = keyed ? (ks_uint64)ks_script_obj_as_integer(ctx, key_obj) : 0;
+
+    uint32_t idx = (uint32_t)(h & BINDING_HANDLE_MASK);
+    const PackedEventLayout* packed = packed_layout(idx);
+    PackedPayload buf(packed ? packed->size : 0);
+
+    const void* data = nullptr;
+    ks_size size = 0;
+    ScriptEvent w;
+
+    if (packed) {
+        if (!marshal_payload(ctx, packed, payload, buf.data())) {
+            KS_LOG_ERROR("[Events] Payload for '%s' does not match its layout.", ks_event_manager_get_event_name(em, h));
+            return 0;
+        }
+        data = buf.data();
+        size = packed->size;
+    }
+    else if (is_script_wrapped(idx)) {
+        w.layout = g_lua_layouts_by_id[idx];
+        w.payload = ks_script_ref_obj(ctx, payload);
+        w.event_name = "";
+        data = &w;
+        size = sizeof(ScriptEvent);
+    }
+    else if (ks_script_obj_type(ctx, payload) != KS_TYPE_NIL) {
+        // Native events only take an instance of their usertype; a table
+        // would otherwise be queued as a zero-filled struct.
+        const char* evt_name = ks_event_manager_get_event_name(em, h);
+        const Ks_Type_Info* info = evt_name ? ks_reflection_get_type(evt_name) : nullptr;
+        data = ks_script_obj_type(ctx, payload) == KS_TYPE_USERDATA ? ks_script_usertype_get_ptr(ctx, payload) : nullptr;
+        if (!data) {
+            KS_LOG_ERROR("[Events] Payload for '%s' does not match its layout.", evt_name);
+            return 0;
+        }
+        size = info ? info->size : 0;
+    }
+
+    if (keyed) ks_event_manager_enqueue_keyed(em, h, key, data, size);
+    else ks_event_manager_enqueue(em, h, data, size);
+    return 0;
+}
+
+ks_returns_count events_dispatch_lua(Ks_Script_Ctx ctx) {
+    Ks_Script_Object up = ks_script_func_get_upvalue(ctx, 1);
+    Ks_EventManager em = (Ks_EventManager)ks_script_lightuserdata_get_ptr(ctx, up);
+
+    ks_event_manager_dispatch_queued(em);
+    return 0;
+}
+
 ks_returns_count events_subscribe_lua(Ks_Script_Ctx ctx) {
     Ks_Script_Object up = ks_script_func_get_upvalue(ctx, 1);
     Ks_EventManager em = (Ks_EventManager)ks_script_lightuserdata_get_ptr(ctx, up);
@@ -207,12 +509,14 @@ ks_returns_count events_subscribe_lua(Ks_Script_Ctx ctx) {
     }
 
     uint32_t idx = (uint32_t)(h & BINDING_HANDLE_MASK);
-    bool is_lua = (idx < g_lua_layouts_by_id.size() && g_lua_layouts_by_id[idx].type != KS_TYPE_NIL);
+    bool is_lua = is_script_wrapped(idx);
 
     LuaSubInfo* info = (LuaSubInfo*)ks_alloc(sizeof(LuaSubInfo), KS_LT_USER_MANAGED, KS_TAG_SCRIPT);
     info->ctx = ctx;
     info->func = ks_script_ref_obj(ctx, ks_script_get_arg(ctx, 2));
     info->is_lua_wrapper = is_lua;
+    info->view = Ks_Script_Object{};
+    info->depth = 0;
 
     if (!is_lua) {
         const char* evt_name = ks_event_manager_get_event_name(em, h);
@@ -231,9 +535,20 @@ ks_returns_count events_subscribe_lua(Ks_Script_Ctx ctx) {
         info->native_info = nullptr;
     }
 
-    Ks_Handle sub_h = ks_event_manager_subscribe_ex(em, h, lua_event_bridge, info, [](void* d) {
-        LuaSubInfo* i = (LuaSubInfo*)d; ks_script_free_obj(i->ctx, i->func); ks_dealloc(i);
-        });
+    // Packed events published from C++ or dispatched from the queue reuse
+    // one view per subscriber instead of allocating a userdata per call;
+    // callbacks must copy fields they want to keep.
+    if (packed_layout(idx) && info->native_info) {
+        ks_script_begin_scope(ctx);
+        Ks_Script_Object view = ks_script_create_usertype_instance(ctx, info->native_info->name);
+        if (view.type == KS_TYPE_USERDATA) {
+            info->view = ks_script_ref_obj(ctx, view);
+            ks_script_promote(ctx, info->view);
+        }
+        ks_script_end_scope(ctx);
+    }
+
+    Ks_Handle sub_h = ks_event_manager_subscribe_ex(em, h, lua_event_bridge, info, cleanup_sub_info);
 
     if (name_copy) ks_dealloc(name_copy);
 
@@ -269,6 +584,7 @@ ks_returns_count events_get_handle_lua(Ks_Script_Ctx ctx) {
 
 void ks_event_manager_lua_bind(Ks_EventManager em, Ks_Script_Ctx ctx) {
     g_lua_layouts_by_id.clear();
+    g_packed_layouts_by_id.clear();
     ks_register_lua_event_reflection();
 
     auto* b = ks_script_usertype_begin_from_ref(ctx, "ScriptEvent");
@@ -284,10 +600,12 @@ void ks_event_manager_lua_bind(Ks_EventManager em, Ks_Script_Ctx ctx) {
         };
 
     reg("register", events_register_lua);
-    reg("register_signal", events_register_lua);
+    reg("register_signal", events_register_signal_lua);
     reg("get_handle", events_get_handle_lua);
     reg("publish", events_publish_lua);
     reg("emit", events_publish_lua);
+    reg("enqueue", events_enqueue_lua);
+    reg("dispatch", events_dispatch_lua);
     reg("subscribe", events_subscribe_lua);
     reg("unsubscribe", events_unsubscribe_lua);
 }
\ No newline at end of file
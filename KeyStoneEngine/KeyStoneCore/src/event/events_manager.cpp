@@ -1,4 +1,5 @@
 #include "../../include/event/events_manager.h"
+#include "../../include/event/events_recorder.h"
 #include "../../include/core/reflection.h"
 #include "../../include/core/handle.h"
 #include "../../include/core/log.h"
@@ -11,27 +12,206 @@
 #include <string>
 #include <shared_mutex>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <numeric>
+#include <string.h>
 
 #define KS_HANDLE_INDEX_MASK 0x00FFFFFF
 
+static constexpr uint32_t KS_EVENT_NO_SLOT = 0xFFFFFFFF;
+
 struct EventSubscriber {
     Ks_Handle sub_id;
     Ks_EventCallback callback;
+    Ks_EventBatchCallback batch_callback;
     void* user_data;
     Ks_UserDataFreeCallback free_cb;
 };
 
+// The type table is immutable once published. Writers build a new copy under
+// the mutex and swap the pointer; publish only reads the current pointers, so
+// it never locks or allocates. Replaced copies are retired into the current
+// epoch and freed two epochs later; see reclaim_retired.
+//
+// Subscriber lists are append-only instead. Subscribe writes the entry past
+// the published count and then bumps the count; unsubscribe only flags the
+// entry as removed and publishes skip flagged entries, so neither copies the
+// list. A list is rebuilt from its live entries when it runs out of room or
+// when removed entries outnumber live ones, which keeps both O(1) amortized.
+struct EventSubscriberEntry {
+    EventSubscriber sub;
+    std::atomic<bool> removed{ false };
+};
+
+struct EventSubscriberList {
+    ks_uint32 capacity;
+    std::atomic<ks_uint32> count{ 0 };
+    EventSubscriberEntry* items;
+};
+
+// Queued payloads are packed per type so dispatch can hand each batch
+// subscriber one contiguous array. The buffers keep their capacity between
+// frames and act as the frame arena for queued events.
+//
+// Coalescing types remember which position holds the latest payload (per key
+// when requested) so a newer enqueue overwrites it instead of appending.
+struct EventQueuedKey {
+    ks_uint64 key;
+    bool keyed;
+};
+
+struct EventQueue {
+    std::vector<ks_byte> bytes;
+    std::vector<ks_uint64> seqs;
+    std::vector<EventQueuedKey> keys;
+    ks_uint32 count = 0;
+    bool any_keyed = false;
+
+    ks_uint32 latest_slot = KS_EVENT_NO_SLOT;
+    std::unordered_map<ks_uint64, ks_uint32> slot_by_key;
+};
+
+// Writer-side view of one published list: the sub slot behind each entry
+// (KS_EVENT_NO_SLOT once removed) and how many entries are still live.
+struct EventLiveList {
+    EventSubscriberList* list = nullptr;
+    std::vector<uint32_t> slots;
+    ks_uint32 live = 0;
+};
+
+// Keyed subscribers are published as one open-addressing table per type
+// whose buckets each hold that key's subscriber list. A bucket is claimed
+// for its key for the life of the table and an unclaimed bucket ends the
+// probe, so a writer can claim a bucket or swap a single key's list in place
+// while publishes read the table. The table is only copied when it has to
+// grow, and the copy shares the lists and drops keys that went empty.
+struct EventKeyBucket {
+    std::atomic<bool> claimed{ false };
+    ks_uint64 key = 0;
+    std::atomic<EventSubscriberList*> subs{ nullptr };
+};
+
+struct EventKeyIndex {
+    ks_uint32 capacity;
+    ks_uint32 claimed;
+    EventKeyBucket* buckets;
+};
+
 struct EventTypeData {
     std::string name;
     const Ks_Type_Info* type_info;
-    std::vector<EventSubscriber> subscribers;
+    std::atomic<EventSubscriberList*> subscribers{ nullptr };
+    EventLiveList live;
+
+    std::atomic<EventKeyIndex*> keyed{ nullptr };
+    std::unordered_map<ks_uint64, EventLiveList> keyed_live;
+
+    EventQueue queue;
+    Ks_Event_Coalesce coalesce = KS_EVENT_COALESCE_NONE;
+    Ks_EventCallback release = nullptr;
+    void* release_user_data = nullptr;
+};
+
+// Subscription handles pack a slot index and a generation under the handle
+// type id, so a stale handle can be rejected without a lookup table. A slot
+// whose generation is exhausted is set aside instead of wrapping, so a stale
+// handle cannot alias a new subscription until every slot has run out.
+static constexpr uint32_t KS_EVENT_SUB_SLOT_BITS = 14;
+static constexpr uint32_t KS_EVENT_SUB_SLOT_MASK = (1u << KS_EVENT_SUB_SLOT_BITS) - 1;
+static constexpr uint32_t KS_EVENT_SUB_GEN_MASK = KS_HANDLE_INDEX_MASK >> KS_EVENT_SUB_SLOT_BITS;
+
+struct EventSubSlot {
+    uint32_t generation;
+    uint32_t type_idx;
+    uint32_t dense_index;
+    uint32_t next_free;
+    ks_uint64 key;
+    bool keyed;
+};
+
+// Every enqueuing thread owns a chunked single-producer queue. The producer
+// appends records and publishes the committed offset; the dispatching thread
+// drains up to that offset and hands emptied chunks back through a free
+// list, so neither side takes a lock once the queue exists.
+static constexpr ks_size KS_EVENT_CHUNK_SIZE = 64 * 1024;
+
+struct EventChunk {
+    std::atomic<ks_size> committed{ 0 };
+    std::atomic<EventChunk*> next{ nullptr };
+    EventChunk* free_next = nullptr;
+    ks_size capacity = 0;
+    ks_byte* data = nullptr;
+};
+
+struct EventRecord {
+    uint32_t type_idx;
+    uint32_t size;
+    ks_uint64 seq;
+    ks_uint64 key;
+    uint32_t keyed;
+};
+
+// While recording, each thread also appends to its own buffer, flagged busy
+// for the duration of the append so a stop can wait it out before merging.
+struct EventPendingLogEntry {
+    ks_uint64 time_ns;
+    ks_uint64 key;
+    const EventTypeData* type;
+    ks_uint32 flags;
+    ks_uint32 size;
+};
+
+struct EventThreadQueue {
+    EventChunk* tail = nullptr;
+    ks_size write_pos = 0;
+
+    EventChunk* head = nullptr;
+    ks_size read_pos = 0;
+
+    std::atomic<EventChunk*> free_chunks{ nullptr };
+
+    std::atomic<bool> record_busy{ false };
+    std::vector<ks_byte> record_bytes;
+};
+
+struct EventTypeTable {
+    ks_uint32 count;
+    EventTypeData** slots;
 };
 
 struct Ks_EventManager_Impl {
     std::mutex mutex;
     std::vector<EventTypeData*> event_types;
+    std::atomic<EventTypeTable*> type_table{ nullptr };
+    std::atomic<ks_uint64> epoch{ 0 };
+    std::atomic<ks_int32> active[2] = { 0, 0 };
+    std::atomic<bool> has_retired{ false };
+    std::vector<void*> retired[2];
+    std::vector<EventSubscriber> retired_subs[2];
+
+    ks_uint64 serial;
+    std::mutex queue_mutex;
+    std::vector<EventThreadQueue*> thread_queues;
+    std::unordered_map<std::thread::id, EventThreadQueue*> queue_by_thread;
+    std::atomic<bool> sequenced{ false };
+    std::atomic<ks_uint64> next_seq{ 0 };
+    std::vector<uint32_t> pending_types;
+    std::vector<ks_byte> sort_scratch;
+    std::vector<ks_uint32> sort_order;
+    std::vector<EventQueuedKey> sort_keys;
+    bool dispatching = false;
+
+    std::atomic<bool> recording{ false };
+    std::mutex record_mutex;
+    Ks_EventLog record_log = nullptr;
+
     std::unordered_map<std::string, uint32_t> name_to_id;
-    std::unordered_map<Ks_Handle, uint32_t> sub_to_event_idx;
+    std::vector<EventSubSlot> sub_slots;
+    uint32_t free_head = KS_EVENT_NO_SLOT;
+    uint32_t free_tail = KS_EVENT_NO_SLOT;
+    std::vector<uint32_t> saturated_slots;
     Ks_Handle_Id h_type_event_def;
     Ks_Handle_Id h_type_sub;
 };
@@ -46,30 +226,474 @@ static uint32_t get_index_from_handle(Ks_Handle h) {
     return (h & KS_HANDLE_INDEX_MASK);
 }
 
+static EventSubscriberList* make_subscriber_list(ks_uint32 capacity) {
+    ks_size bytes = sizeof(EventSubscriberList) + sizeof(EventSubscriberEntry) * capacity;
+    auto* list = new(ks_alloc_debug(bytes, KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "EventSubscriberList")) EventSubscriberList();
+    list->capacity = capacity;
+    list->items = (EventSubscriberEntry*)(list + 1);
+    for (ks_uint32 i = 0; i < capacity; ++i) new(&list->items[i]) EventSubscriberEntry();
+    return list;
+}
+
+// Visits the entries published so far that have not been removed.
+template <typename Fn>
+static void for_each_subscriber(const EventSubscriberList* list, Fn&& fn) {
+    if (!list) return;
+    ks_uint32 count = list->count.load(std::memory_order_acquire);
+    for (ks_uint32 i = 0; i < count; ++i) {
+        if (!list->items[i].removed.load(std::memory_order_acquire)) fn(list->items[i].sub);
+    }
+}
+
+static EventTypeTable* make_type_table(const std::vector<EventTypeData*>& types) {
+    ks_uint32 count = (ks_uint32)types.size();
+    ks_size bytes = sizeof(EventTypeTable) + sizeof(EventTypeData*) * count;
+    auto* table = (EventTypeTable*)ks_alloc_debug(bytes, KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "EventTypeTable");
+    table->count = count;
+    table->slots = (EventTypeData**)(table + 1);
+    if (count > 0) memcpy(table->slots, types.data(), sizeof(EventTypeData*) * count);
+    return table;
+}
+
+static ks_size payload_stride(const EventTypeData* data) {
+    return data->type_info ? data->type_info->size : 0;
+}
+
+static std::atomic<ks_uint64> s_manager_serial{ 0 };
+
+struct EventQueueCache {
+    ks_uint64 manager_serial;
+    EventThreadQueue* queue;
+};
+
+static thread_local EventQueueCache s_queue_cache = { 0, nullptr };
+
+static EventChunk* make_chunk(ks_size capacity) {
+    void* mem = ks_alloc_debug(sizeof(EventChunk) + capacity, KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "EventChunk");
+    EventChunk* chunk = new(mem) EventChunk();
+    chunk->capacity = capacity;
+    chunk->data = (ks_byte*)(chunk + 1);
+    return chunk;
+}
+
+static EventThreadQueue* get_thread_queue(Ks_EventManager_Impl* impl) {
+    if (s_queue_cache.manager_serial == impl->serial) return s_queue_cache.queue;
+
+    std::lock_guard<std::mutex> lock(impl->queue_mutex);
+    EventThreadQueue*& queue = impl->queue_by_thread[std::this_thread::get_id()];
+    if (!queue) {
+        void* mem = ks_alloc_debug(sizeof(EventThreadQueue), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "EventThreadQueue");
+        queue = new(mem) EventThreadQueue();
+        queue->head = queue->tail = make_chunk(KS_EVENT_CHUNK_SIZE);
+        impl->thread_queues.push_back(queue);
+    }
+
+    s_queue_cache = { impl->serial, queue };
+    return queue;
+}
+
+// Producer side. Only the owning thread pops the free list, so a plain CAS
+// loop is safe from ABA.
+static EventChunk* acquire_chunk(EventThreadQueue* q, ks_size needed) {
+    if (needed > KS_EVENT_CHUNK_SIZE) return make_chunk(needed);
+
+    EventChunk* top = q->free_chunks.load(std::memory_order_acquire);
+    while (top && !q->free_chunks.compare_exchange_weak(top, top->free_next, std::memory_order_acquire)) {}
+    return top ? top : make_chunk(KS_EVENT_CHUNK_SIZE);
+}
+
+static void push_record(EventThreadQueue* q, uint32_t type_idx, const void* payload, ks_size size, ks_uint64 seq, const ks_uint64* key) {
+    ks_size bytes = (sizeof(EventRecord) + size + 7) & ~(ks_size)7;
+
+    if (q->write_pos + bytes > q->tail->capacity) {
+        EventChunk* chunk = acquire_chunk(q, bytes);
+        q->tail->next.store(chunk, std::memory_order_release);
+        q->tail = chunk;
+        q->write_pos = 0;
+    }
+
+    ks_byte* dst = q->tail->data + q->write_pos;
+    EventRecord rec = { type_idx, (uint32_t)size, seq, key ? *key : 0, key ? 1u : 0u };
+    memcpy(dst, &rec, sizeof(rec));
+    if (size > 0) {
+        if (payload) memcpy(dst + sizeof(rec), payload, size);
+        else memset(dst + sizeof(rec), 0, size);
+    }
+
+    q->write_pos += bytes;
+    q->tail->committed.store(q->write_pos, std::memory_order_release);
+}
+
+static void recycle_chunk(EventThreadQueue* q, EventChunk* chunk) {
+    if (chunk->capacity != KS_EVENT_CHUNK_SIZE) {
+        ks_dealloc(chunk);
+        return;
+    }
+
+    chunk->committed.store(0, std::memory_order_relaxed);
+    chunk->next.store(nullptr, std::memory_order_relaxed);
+    EventChunk* top = q->free_chunks.load(std::memory_order_relaxed);
+    do {
+        chunk->free_next = top;
+    } while (!q->free_chunks.compare_exchange_weak(top, chunk, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Consumer side. The producer commits a chunk's final offset before linking
+// the next one, so the offset is re-read once a successor is visible.
+template<typename F>
+static void drain_thread_queue(EventThreadQueue* q, F&& on_record) {
+    for (;;) {
+        EventChunk* chunk = q->head;
+        EventChunk* next = chunk->next.load(std::memory_order_acquire);
+        ks_size end = chunk->committed.load(std::memory_order_acquire);
+
+        while (q->read_pos < end) {
+            EventRecord rec;
+            memcpy(&rec, chunk->data + q->read_pos, sizeof(rec));
+            on_record(rec, chunk->data + q->read_pos + sizeof(rec));
+            q->read_pos += (sizeof(EventRecord) + rec.size + 7) & ~(ks_size)7;
+        }
+
+        if (!next) break;
+        q->head = next;
+        q->read_pos = 0;
+        recycle_chunk(q, chunk);
+    }
+}
+
+static void free_thread_queue(EventThreadQueue* q) {
+    EventChunk* chunk = q->head;
+    while (chunk) {
+        EventChunk* next = chunk->next.load();
+        ks_dealloc(chunk);
+        chunk = next;
+    }
+    chunk = q->free_chunks.load();
+    while (chunk) {
+        EventChunk* next = chunk->free_next;
+        ks_dealloc(chunk);
+        chunk = next;
+    }
+    q->~EventThreadQueue();
+    ks_dealloc(q);
+}
+
+// Set while a manager runs subscriber callbacks on this thread. Events those
+// callbacks publish or enqueue are not recorded: replaying the outer event
+// runs the same callbacks, which would emit them a second time.
+static thread_local const Ks_EventManager_Impl* s_callback_impl = nullptr;
+
+class CallbackScope {
+public:
+    explicit CallbackScope(const Ks_EventManager_Impl* impl) : m_prev(s_callback_impl) { s_callback_impl = impl; }
+    ~CallbackScope() { s_callback_impl = m_prev; }
+private:
+    const Ks_EventManager_Impl* m_prev;
+};
+
+// Lock-free on the publishing thread: the entry goes to that thread's own
+// buffer. The busy flag is raised before `recording` is re-checked, and a
+// stop clears `recording` before waiting on the flags, so every append a stop
+// misses has already seen recording off.
+static void record_event(Ks_EventManager_Impl* impl, const EventTypeData* data, const void* payload, ks_uint32 flags, ks_uint64 key) {
+    if (s_callback_impl == impl) return;
+
+    EventThreadQueue* q = get_thread_queue(impl);
+    q->record_busy.store(true);
+    if (impl->recording.load()) {
+        ks_uint32 size = payload && data ? (ks_uint32)payload_stride(data) : 0;
+        EventPendingLogEntry entry = { ks_event_log_now_ns(), key, data, flags, size };
+        ks_size offset = q->record_bytes.size();
+        q->record_bytes.resize(offset + sizeof(entry) + ((size + 7) & ~(ks_size)7));
+        memcpy(q->record_bytes.data() + offset, &entry, sizeof(entry));
+        if (size > 0) memcpy(q->record_bytes.data() + offset + sizeof(entry), payload, size);
+    }
+    q->record_busy.store(false);
+}
+
+// Must hold impl->record_mutex with `recording` already cleared. Waits for
+// in-flight appends, then moves every thread's entries into the log in
+// timestamp order.
+static void flush_recording(Ks_EventManager_Impl* impl) {
+    struct PendingRef { ks_uint64 time_ns; const ks_byte* entry; };
+    std::vector<PendingRef> refs;
+
+    std::lock_guard<std::mutex> lock(impl->queue_mutex);
+    for (auto* q : impl->thread_queues) {
+        while (q->record_busy.load()) std::this_thread::yield();
+        for (ks_size pos = 0; pos < q->record_bytes.size();) {
+            EventPendingLogEntry entry;
+            memcpy(&entry, q->record_bytes.data() + pos, sizeof(entry));
+            refs.push_back({ entry.time_ns, q->record_bytes.data() + pos });
+            pos += sizeof(entry) + ((entry.size + 7) & ~(ks_size)7);
+        }
+    }
+
+    std::stable_sort(refs.begin(), refs.end(), [](const PendingRef& a, const PendingRef& b) { return a.time_ns < b.time_ns; });
+    for (const PendingRef& ref : refs) {
+        EventPendingLogEntry entry;
+        memcpy(&entry, ref.entry, sizeof(entry));
+        const void* payload = entry.size > 0 ? ref.entry + sizeof(entry) : nullptr;
+        if (impl->record_log) {
+            ks_event_log_append_at(impl->record_log, entry.time_ns, entry.type ? entry.type->name.c_str() : nullptr, payload, entry.flags, entry.key);
+        }
+    }
+
+    for (auto* q : impl->thread_queues) q->record_bytes.clear();
+}
+
+static void cleanup_subscriber(const EventSubscriber& sub) {
+    if (sub.free_cb && sub.user_data) sub.free_cb(sub.user_data);
+}
+
+// Set while free callbacks run, so a callback that publishes does not try to
+// re-enter the mutex its own thread already holds.
+static thread_local bool s_reclaiming = false;
+
+// Must hold impl->mutex. A publish announces itself in the slot of the epoch
+// it observed, and anything it can read was live in that epoch. Copies
+// retired during epoch E are therefore unreachable once the epoch has moved
+// to E + 2, and moving from E to E + 1 only needs the publishes of E - 1 to
+// have finished. Each call advances at most twice, so overlapping publishes
+// never stall reclamation as long as each one eventually returns.
+static void reclaim_retired(Ks_EventManager_Impl* impl, bool force = false) {
+    s_reclaiming = true;
+    for (int step = 0; step < 2 && impl->has_retired.load(); ++step) {
+        ks_uint64 epoch = impl->epoch.load();
+        ks_uint32 prev = (ks_uint32)(epoch + 1) & 1;
+        if (!force && impl->active[prev].load() != 0) break;
+
+        for (void* p : impl->retired[prev]) ks_dealloc(p);
+        impl->retired[prev].clear();
+        for (auto& sub : impl->retired_subs[prev]) cleanup_subscriber(sub);
+        impl->retired_subs[prev].clear();
+
+        impl->epoch.store(epoch + 1);
+        ks_uint32 held = (ks_uint32)epoch & 1;
+        impl->has_retired.store(!impl->retired[held].empty() || !impl->retired_subs[held].empty());
+    }
+    s_reclaiming = false;
+}
+
+// Must hold impl->mutex.
+static void retire(Ks_EventManager_Impl* impl, void* ptr) {
+    impl->retired[impl->epoch.load() & 1].push_back(ptr);
+    impl->has_retired.store(true);
+}
+
+static void retire_subscriber(Ks_EventManager_Impl* impl, const EventSubscriber& sub) {
+    impl->retired_subs[impl->epoch.load() & 1].push_back(sub);
+    impl->has_retired.store(true);
+}
+
+// The last publish to leave its epoch reclaims what it was holding back. A
+// writer holding the mutex reclaims on its own way out, so losing the
+// try_lock here only defers the work to that writer or to the next dispatch.
+class PublishScope {
+public:
+    explicit PublishScope(Ks_EventManager_Impl* impl) : m_impl(impl) {
+        for (;;) {
+            ks_uint64 epoch = m_impl->epoch.load();
+            m_slot = (ks_uint32)epoch & 1;
+            m_impl->active[m_slot].fetch_add(1);
+            if (m_impl->epoch.load() == epoch) break;
+            m_impl->active[m_slot].fetch_sub(1);
+        }
+    }
+    ~PublishScope() {
+        if (m_impl->active[m_slot].fetch_sub(1) != 1 || !m_impl->has_retired.load() || s_reclaiming) return;
+        std::unique_lock<std::mutex> lock(m_impl->mutex, std::try_to_lock);
+        if (lock.owns_lock()) reclaim_retired(m_impl);
+    }
+private:
+    Ks_EventManager_Impl* m_impl;
+    ks_uint32 m_slot;
+};
+
 KS_API Ks_EventManager ks_event_manager_create() {
     auto* impl = new(ks_alloc_debug(sizeof(Ks_EventManager_Impl), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEventManagerImpl")) Ks_EventManager_Impl();
     impl->h_type_event_def = ks_handle_register("EventType");
     impl->h_type_sub = ks_handle_register("EventSub");
+    impl->serial = ++s_manager_serial;
     ensure_signal_reflection();
     impl->event_types.reserve(64);
     return (Ks_EventManager)impl;
 }
 
-static void cleanup_subscriber(EventSubscriber& sub) {
-    if (sub.free_cb && sub.user_data) {
-        sub.free_cb(sub.user_data);
-        sub.user_data = nullptr;
+static ks_uint32 hash_event_key(ks_uint64 key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (ks_uint32)key;
+}
+
+static EventKeyIndex* make_key_index(ks_uint32 capacity) {
+    ks_size bytes = sizeof(EventKeyIndex) + sizeof(EventKeyBucket) * capacity;
+    auto* index = (EventKeyIndex*)ks_alloc_debug(bytes, KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "EventKeyIndex");
+    index->capacity = capacity;
+    index->claimed = 0;
+    index->buckets = (EventKeyBucket*)(index + 1);
+    for (ks_uint32 b = 0; b < capacity; ++b) new(&index->buckets[b]) EventKeyBucket();
+    return index;
+}
+
+static EventKeyBucket* find_key_bucket(const EventKeyIndex* index, ks_uint64 key) {
+    ks_uint32 mask = index->capacity - 1;
+    for (ks_uint32 b = hash_event_key(key) & mask; index->buckets[b].claimed.load(std::memory_order_acquire); b = (b + 1) & mask) {
+        if (index->buckets[b].key == key) return &index->buckets[b];
+    }
+    return nullptr;
+}
+
+// Writer only. The key is written before the bucket is marked claimed, so a
+// probing publish never sees a half-claimed bucket.
+static EventKeyBucket* claim_key_bucket(EventKeyIndex* index, ks_uint64 key) {
+    ks_uint32 mask = index->capacity - 1;
+    ks_uint32 b = hash_event_key(key) & mask;
+    while (index->buckets[b].claimed.load(std::memory_order_relaxed)) b = (b + 1) & mask;
+    index->buckets[b].key = key;
+    index->buckets[b].claimed.store(true, std::memory_order_release);
+    index->claimed++;
+    return &index->buckets[b];
+}
+
+// Must hold impl->mutex. Rehashes the live keys into a table with room for
+// one more; the lists move over as-is and the old table is retired.
+static EventKeyIndex* grow_key_index(Ks_EventManager_Impl* impl, EventTypeData* data, EventKeyIndex* old) {
+    ks_uint32 live = 1;
+    for (ks_uint32 b = 0; old && b < old->capacity; ++b) {
+        if (old->buckets[b].subs.load(std::memory_order_relaxed)) live++;
+    }
+    ks_uint32 capacity = 8;
+    while (capacity < live * 2) capacity <<= 1;
+
+    EventKeyIndex* index = make_key_index(capacity);
+    for (ks_uint32 b = 0; old && b < old->capacity; ++b) {
+        EventSubscriberList* list = old->buckets[b].subs.load(std::memory_order_relaxed);
+        if (list) claim_key_bucket(index, old->buckets[b].key)->subs.store(list, std::memory_order_relaxed);
     }
+    data->keyed.store(index);
+    if (old) retire(impl, old);
+    return index;
+}
+
+// Must hold impl->mutex. Swaps a single key's list; the rest of the index is
+// left untouched.
+static void publish_key(Ks_EventManager_Impl* impl, EventTypeData* data, ks_uint64 key, EventSubscriberList* list) {
+    EventKeyIndex* index = data->keyed.load();
+    EventKeyBucket* bucket = index ? find_key_bucket(index, key) : nullptr;
+    if (!bucket) {
+        if (!list) return;
+        if (!index || (index->claimed + 1) * 2 > index->capacity) index = grow_key_index(impl, data, index);
+        bucket = claim_key_bucket(index, key);
+    }
+    EventSubscriberList* old = bucket->subs.exchange(list);
+    if (old) retire(impl, old);
+}
+
+// Must hold impl->mutex. Moves the live entries, in order, into a new list
+// with room for `capacity` (no list at all when nothing is live) and
+// publishes it in place of the old one, which is retired.
+static void rebuild_list(Ks_EventManager_Impl* impl, EventTypeData* data, const ks_uint64* key, EventLiveList& live, ks_uint32 capacity) {
+    EventSubscriberList* list = capacity > 0 ? make_subscriber_list(capacity) : nullptr;
+    ks_uint32 n = 0;
+    for (ks_uint32 i = 0; list && i < (ks_uint32)live.slots.size(); ++i) {
+        uint32_t slot = live.slots[i];
+        if (slot == KS_EVENT_NO_SLOT) continue;
+        list->items[n].sub = live.list->items[i].sub;
+        impl->sub_slots[slot].dense_index = n;
+        live.slots[n++] = slot;
+    }
+    live.slots.resize(n);
+    if (list) list->count.store(n, std::memory_order_release);
+    live.list = list;
+
+    if (key) {
+        publish_key(impl, data, *key, list);
+        return;
+    }
+    EventSubscriberList* old = data->subscribers.exchange(list);
+    if (old) retire(impl, old);
+}
+
+static void invoke_subscriber(const EventSubscriber& sub, const void* data_ptr) {
+    if (sub.batch_callback) sub.batch_callback(data_ptr, 1, sub.user_data);
+    else sub.callback(data_ptr, sub.user_data);
+}
+
+static void push_free_slot(Ks_EventManager_Impl* impl, uint32_t slot) {
+    impl->sub_slots[slot].next_free = KS_EVENT_NO_SLOT;
+    if (impl->free_tail != KS_EVENT_NO_SLOT) impl->sub_slots[impl->free_tail].next_free = slot;
+    else impl->free_head = slot;
+    impl->free_tail = slot;
+}
+
+// Slots are reused in FIFO order so a generation takes as long as possible
+// to come around again. Saturated slots only return once the slot space is
+// exhausted, after at least (slots * generations) subscriptions.
+static uint32_t alloc_sub_slot(Ks_EventManager_Impl* impl) {
+    if (impl->free_head == KS_EVENT_NO_SLOT && impl->sub_slots.size() > KS_EVENT_SUB_SLOT_MASK && !impl->saturated_slots.empty()) {
+        KS_LOG_WARN("[Events] Subscription handles exhausted, recycling %zu saturated slots", impl->saturated_slots.size());
+        for (uint32_t slot : impl->saturated_slots) {
+            impl->sub_slots[slot].generation = 1;
+            push_free_slot(impl, slot);
+        }
+        impl->saturated_slots.clear();
+    }
+    if (impl->free_head != KS_EVENT_NO_SLOT) {
+        uint32_t slot = impl->free_head;
+        impl->free_head = impl->sub_slots[slot].next_free;
+        if (impl->free_head == KS_EVENT_NO_SLOT) impl->free_tail = KS_EVENT_NO_SLOT;
+        return slot;
+    }
+    if (impl->sub_slots.size() > KS_EVENT_SUB_SLOT_MASK) return KS_EVENT_NO_SLOT;
+    impl->sub_slots.push_back({ 1, 0, 0, KS_EVENT_NO_SLOT });
+    return (uint32_t)impl->sub_slots.size() - 1;
+}
+
+static void free_sub_slot(Ks_EventManager_Impl* impl, uint32_t slot) {
+    EventSubSlot& s = impl->sub_slots[slot];
+    s.dense_index = KS_EVENT_NO_SLOT;
+    if (s.generation == KS_EVENT_SUB_GEN_MASK) {
+        impl->saturated_slots.push_back(slot);
+        return;
+    }
+    s.generation++;
+    push_free_slot(impl, slot);
 }
 
 KS_API void ks_event_manager_destroy(Ks_EventManager em) {
     if (!em) return;
     auto* impl = (Ks_EventManager_Impl*)em;
 
+    if (impl->record_log) {
+        std::lock_guard<std::mutex> lock(impl->record_mutex);
+        impl->recording.store(false);
+        flush_recording(impl);
+    }
+
+    reclaim_retired(impl, true);
+    if (EventTypeTable* table = impl->type_table.load()) ks_dealloc(table);
+    for (auto* queue : impl->thread_queues) {
+        drain_thread_queue(queue, [&](const EventRecord& rec, const ks_byte* payload) {
+            EventTypeData* data = rec.type_idx < impl->event_types.size() ? impl->event_types[rec.type_idx] : nullptr;
+            if (data && data->release) data->release(payload, data->release_user_data);
+        });
+        free_thread_queue(queue);
+    }
+
     for (auto* type_data : impl->event_types) {
         if (!type_data) continue;
-        for (auto& sub : type_data->subscribers) {
-            cleanup_subscriber(sub);
+        for_each_subscriber(type_data->live.list, cleanup_subscriber);
+        for (auto& [key, live] : type_data->keyed_live) {
+            for_each_subscriber(live.list, cleanup_subscriber);
+        }
+        if (EventSubscriberList* list = type_data->subscribers.load()) ks_dealloc(list);
+        if (EventKeyIndex* index = type_data->keyed.load()) {
+            for (ks_uint32 b = 0; b < index->capacity; ++b) {
+                if (EventSubscriberList* list = index->buckets[b].subs.load()) ks_dealloc(list);
+            }
+            ks_dealloc(index);
         }
         type_data->~EventTypeData();
         ks_dealloc(type_data);
@@ -109,6 +733,10 @@ KS_API Ks_Handle ks_event_manager_register_type(Ks_EventManager em, const char*
     }
     impl->event_types[vector_idx] = data;
 
+    EventTypeTable* old_table = impl->type_table.exchange(make_type_table(impl->event_types));
+    if (old_table) retire(impl, old_table);
+    reclaim_retired(impl);
+
     impl->name_to_id[type_name] = vector_idx;
 
     return new_handle;
@@ -120,6 +748,35 @@ KS_API Ks_Handle ks_event_manager_register_signal(Ks_EventManager em, const char
     return ks_event_manager_register_type(em, signal_name);
 }
 
+KS_API Ks_Handle ks_event_manager_register_type_ex(Ks_EventManager em, const char* type_name, Ks_Event_Coalesce coalesce) {
+    Ks_Handle handle = ks_event_manager_register_type(em, type_name);
+    if (handle == KS_INVALID_HANDLE) return handle;
+
+    auto* impl = (Ks_EventManager_Impl*)em;
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->event_types[get_index_from_handle(handle)]->coalesce = coalesce;
+    return handle;
+}
+
+KS_API Ks_Handle ks_event_manager_register_signal_ex(Ks_EventManager em, const char* signal_name, Ks_Event_Coalesce coalesce) {
+    ensure_signal_reflection();
+    ks_reflection_register_typedef("Ks_Signal", signal_name);
+    return ks_event_manager_register_type_ex(em, signal_name, coalesce);
+}
+
+KS_API void ks_event_manager_set_queued_release(Ks_EventManager em, Ks_Handle event_handle, Ks_EventCallback release, void* user_data) {
+    auto* impl = (Ks_EventManager_Impl*)em;
+    uint32_t idx = get_index_from_handle(event_handle);
+
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    if (!ks_handle_is_type(event_handle, impl->h_type_event_def) || idx >= impl->event_types.size() || !impl->event_types[idx]) {
+        ks_epush(KS_ERROR_LEVEL_BASE, "Core", "EventManager", KS_ERROR_INVALID_HANDLE, "Set queued release failed: Invalid event handle");
+        return;
+    }
+    impl->event_types[idx]->release = release;
+    impl->event_types[idx]->release_user_data = user_data;
+}
+
 KS_API Ks_Handle ks_event_manager_subscribe(Ks_EventManager em, Ks_Handle event_handle, Ks_EventCallback callback, void* user_data){
     return ks_event_manager_subscribe_ex(em, event_handle, callback, user_data, nullptr);
 }
@@ -150,9 +807,7 @@ const char* ks_event_manager_get_event_name(Ks_EventManager em, Ks_Handle event_
     return impl->event_types[idx]->name.c_str();
 }
 
-Ks_Handle ks_event_manager_subscribe_ex(Ks_EventManager em, Ks_Handle event_handle, Ks_EventCallback callback, void* user_data, Ks_UserDataFreeCallback free_cb) {
-    auto* impl = (Ks_EventManager_Impl*)em;
-
+static Ks_Handle add_subscriber(Ks_EventManager_Impl* impl, Ks_Handle event_handle, EventSubscriber sub, const ks_uint64* key = nullptr) {
     if (!ks_handle_is_type(event_handle, impl->h_type_event_def)) {
         ks_epush(
             KS_ERROR_LEVEL_BASE, 
@@ -173,44 +828,91 @@ Ks_Handle ks_event_manager_subscribe_ex(Ks_EventManager em, Ks_Handle event_hand
 
     EventTypeData* data = impl->event_types[evt_idx];
 
-    Ks_Handle sub_h = ks_handle_make(impl->h_type_sub);
+    uint32_t slot = alloc_sub_slot(impl);
+    if (slot == KS_EVENT_NO_SLOT) {
+        ks_epush_fmt(KS_ERROR_LEVEL_BASE, "Core", "EventManager", KS_ERROR_INVALID_HANDLE,
+            "Subscribe failed: more than %u live subscriptions", KS_EVENT_SUB_SLOT_MASK + 1);
+        return KS_INVALID_HANDLE;
+    }
 
-    EventSubscriber sub;
+    EventLiveList& live = key ? data->keyed_live[*key] : data->live;
+
+    if (!live.list || live.slots.size() == live.list->capacity) {
+        rebuild_list(impl, data, key, live, std::max<ks_uint32>(4, (live.live + 1) * 2));
+    }
+
+    EventSubSlot& s = impl->sub_slots[slot];
+    s.type_idx = evt_idx;
+    s.dense_index = (uint32_t)live.slots.size();
+    s.key = key ? *key : 0;
+    s.keyed = key != nullptr;
+
+    Ks_Handle sub_h = ((Ks_Handle)impl->h_type_sub << 24) | (s.generation << KS_EVENT_SUB_SLOT_BITS) | slot;
     sub.sub_id = sub_h;
-    sub.callback = callback;
-    sub.user_data = user_data;
-    sub.free_cb = free_cb;
 
-    data->subscribers.push_back(sub);
-    impl->sub_to_event_idx[sub_h] = evt_idx;
+    // The entry is written past the published count, so no publish can see
+    // it until the count moves.
+    live.list->items[s.dense_index].sub = sub;
+    live.slots.push_back(slot);
+    live.live++;
+    live.list->count.store(s.dense_index + 1, std::memory_order_release);
+    reclaim_retired(impl);
 
     return sub_h;
 }
 
+Ks_Handle ks_event_manager_subscribe_ex(Ks_EventManager em, Ks_Handle event_handle, Ks_EventCallback callback, void* user_data, Ks_UserDataFreeCallback free_cb) {
+    EventSubscriber sub = { KS_INVALID_HANDLE, callback, nullptr, user_data, free_cb };
+    return add_subscriber((Ks_EventManager_Impl*)em, event_handle, sub);
+}
+
+KS_API Ks_Handle ks_event_manager_subscribe_batch(Ks_EventManager em, Ks_Handle event_handle, Ks_EventBatchCallback callback, void* user_data) {
+    EventSubscriber sub = { KS_INVALID_HANDLE, nullptr, callback, user_data, nullptr };
+    return add_subscriber((Ks_EventManager_Impl*)em, event_handle, sub);
+}
+
+KS_API Ks_Handle ks_event_manager_subscribe_keyed(Ks_EventManager em, Ks_Handle event_handle, ks_uint64 key, Ks_EventCallback callback, void* user_data, Ks_UserDataFreeCallback free_cb) {
+    EventSubscriber sub = { KS_INVALID_HANDLE, callback, nullptr, user_data, free_cb };
+    return add_subscriber((Ks_EventManager_Impl*)em, event_handle, sub, &key);
+}
+
 KS_API void ks_event_manager_unsubscribe(Ks_EventManager em, Ks_Handle sub_handle) {
     auto* impl = (Ks_EventManager_Impl*)em;
 
     if (!ks_handle_is_type(sub_handle, impl->h_type_sub)) return;
 
+    uint32_t slot = sub_handle & KS_EVENT_SUB_SLOT_MASK;
+    uint32_t generation = (sub_handle & KS_HANDLE_INDEX_MASK) >> KS_EVENT_SUB_SLOT_BITS;
+
     std::lock_guard<std::mutex> lock(impl->mutex);
 
-    auto map_it = impl->sub_to_event_idx.find(sub_handle);
-    if (map_it == impl->sub_to_event_idx.end()) return;
+    if (slot >= impl->sub_slots.size()) return;
+    EventSubSlot& s = impl->sub_slots[slot];
+    if (s.generation != generation || s.dense_index == KS_EVENT_NO_SLOT) return;
 
-    uint32_t evt_idx = map_it->second;
-    if (evt_idx >= impl->event_types.size() || !impl->event_types[evt_idx]) return;
+    EventTypeData* data = impl->event_types[s.type_idx];
+    auto keyed_it = s.keyed ? data->keyed_live.find(s.key) : data->keyed_live.end();
+    EventLiveList& live = s.keyed ? keyed_it->second : data->live;
+    uint32_t idx = s.dense_index;
+    ks_uint64 key = s.key;
+    const ks_uint64* key_ptr = s.keyed ? &key : nullptr;
 
-    EventTypeData* data = impl->event_types[evt_idx];
-    auto& subs = data->subscribers;
+    // Publishes that start from here on skip the entry. One already past the
+    // flag may still be calling it, so the free callback waits for the
+    // current epoch to be reclaimed.
+    live.list->items[idx].removed.store(true, std::memory_order_release);
+    retire_subscriber(impl, live.list->items[idx].sub);
+    live.slots[idx] = KS_EVENT_NO_SLOT;
+    live.live--;
+    free_sub_slot(impl, slot);
 
-    for (auto it = subs.begin(); it != subs.end(); ++it) {
-        if (it->sub_id == sub_handle) {
-            cleanup_subscriber(*it);
-            subs.erase(it);
-            break;
-        }
+    if (live.live == 0) {
+        rebuild_list(impl, data, key_ptr, live, 0);
+        if (key_ptr) data->keyed_live.erase(keyed_it);
+    } else if (live.live * 2 < live.slots.size()) {
+        rebuild_list(impl, data, key_ptr, live, live.live * 2);
     }
-    impl->sub_to_event_idx.erase(map_it);
+    reclaim_retired(impl);
 }
 
 KS_API void ks_event_manager_publish(Ks_EventManager em, Ks_Handle event_handle, const void* data_ptr) {
@@ -219,21 +921,241 @@ KS_API void ks_event_manager_publish(Ks_EventManager em, Ks_Handle event_handle,
 
     uint32_t idx = event_handle & KS_HANDLE_INDEX_MASK;
 
-    std::vector<EventSubscriber> safe_subs;
-    {
-        KS_PROFILE_SCOPE("EventManager::Lock&Copy");
-        std::lock_guard<std::mutex> lock(impl->mutex);
-        if (idx >= impl->event_types.size() || !impl->event_types[idx]) return;
-        safe_subs = impl->event_types[idx]->subscribers;
+    PublishScope scope(impl);
+    EventTypeTable* table = impl->type_table.load();
+    if (!table || idx >= table->count || !table->slots[idx]) return;
+    if (impl->recording.load(std::memory_order_relaxed)) record_event(impl, table->slots[idx], data_ptr, 0, 0);
+
+    const EventSubscriberList* subs = table->slots[idx]->subscribers.load();
+    if (!subs) return;
+
+    KS_PROFILE_SCOPE("EventManager::Callbacks");
+    CallbackScope callbacks(impl);
+    for_each_subscriber(subs, [&](const EventSubscriber& sub) { invoke_subscriber(sub, data_ptr); });
+}
+
+KS_API void ks_event_manager_publish_keyed(Ks_EventManager em, Ks_Handle event_handle, ks_uint64 key, const void* data_ptr) {
+    KS_PROFILE_SCOPE("EventManager::PublishKeyed");
+    auto* impl = (Ks_EventManager_Impl*)em;
+
+    uint32_t idx = event_handle & KS_HANDLE_INDEX_MASK;
+
+    PublishScope scope(impl);
+    EventTypeTable* table = impl->type_table.load();
+    if (!table || idx >= table->count || !table->slots[idx]) return;
+    EventTypeData* data = table->slots[idx];
+    if (impl->recording.load(std::memory_order_relaxed)) record_event(impl, data, data_ptr, KS_EVENT_LOG_KEYED, key);
+
+    CallbackScope callbacks(impl);
+    const EventKeyIndex* index = data->keyed.load();
+    const EventKeyBucket* bucket = index ? find_key_bucket(index, key) : nullptr;
+    const EventSubscriberList* keyed = bucket ? bucket->subs.load() : nullptr;
+    for_each_subscriber(keyed, [&](const EventSubscriber& sub) { invoke_subscriber(sub, data_ptr); });
+    for_each_subscriber(data->subscribers.load(), [&](const EventSubscriber& sub) { invoke_subscriber(sub, data_ptr); });
+}
+
+KS_API void ks_event_manager_emit(Ks_EventManager em, Ks_Handle signal_handle){
+    ks_event_manager_publish(em, signal_handle, nullptr);
+}
+
+static void enqueue_event(Ks_EventManager_Impl* impl, Ks_Handle event_handle, const ks_uint64* key, const void* data_ptr, ks_size size) {
+    uint32_t idx = get_index_from_handle(event_handle);
+
+    PublishScope scope(impl);
+    EventTypeTable* table = impl->type_table.load();
+    if (!table || idx >= table->count || !table->slots[idx]) return;
+    EventTypeData* data = table->slots[idx];
+
+    ks_size stride = payload_stride(data);
+    if (data_ptr && size != stride) {
+        ks_epush_fmt(KS_ERROR_LEVEL_BASE, "Core", "EventManager", KS_ERROR_TYPE_MISMATCH,
+            "Enqueue of '%s' failed: payload is %zu bytes, expected %zu", data->name.c_str(), size, stride);
+        return;
     }
+    if (impl->recording.load(std::memory_order_relaxed)) {
+        record_event(impl, data, data_ptr, KS_EVENT_LOG_QUEUED | (key ? KS_EVENT_LOG_KEYED : 0), key ? *key : 0);
+    }
+
+    ks_uint64 seq = impl->sequenced.load(std::memory_order_relaxed) ? impl->next_seq.fetch_add(1, std::memory_order_relaxed) + 1 : 0;
+    push_record(get_thread_queue(impl), idx, data_ptr, stride, seq, key);
+}
+
+KS_API void ks_event_manager_enqueue(Ks_EventManager em, Ks_Handle event_handle, const void* data_ptr, ks_size size) {
+    enqueue_event((Ks_EventManager_Impl*)em, event_handle, nullptr, data_ptr, size);
+}
+
+KS_API void ks_event_manager_enqueue_keyed(Ks_EventManager em, Ks_Handle event_handle, ks_uint64 key, const void* data_ptr, ks_size size) {
+    enqueue_event((Ks_EventManager_Impl*)em, event_handle, &key, data_ptr, size);
+}
+
+KS_API void ks_event_manager_record_start(Ks_EventManager em, Ks_EventLog log) {
+    auto* impl = (Ks_EventManager_Impl*)em;
+    std::lock_guard<std::mutex> lock(impl->record_mutex);
+    impl->recording.store(false);
+    flush_recording(impl);
+    impl->record_log = log;
+    impl->recording.store(log != nullptr);
+}
+
+KS_API void ks_event_manager_record_stop(Ks_EventManager em) {
+    ks_event_manager_record_start(em, nullptr);
+}
+
+KS_API void ks_event_manager_set_sequenced(Ks_EventManager em, ks_bool enabled) {
+    ((Ks_EventManager_Impl*)em)->sequenced.store(enabled != 0);
+}
+
+static void release_queued(const EventTypeData* data, const void* payload) {
+    if (data->release) data->release(payload, data->release_user_data);
+}
+
+static ks_uint32& coalesce_slot(EventQueue& q, Ks_Event_Coalesce mode, const EventRecord& rec) {
+    if (mode == KS_EVENT_COALESCE_LATEST_PER_KEY && rec.keyed) {
+        return q.slot_by_key.try_emplace(rec.key, KS_EVENT_NO_SLOT).first->second;
+    }
+    return q.latest_slot;
+}
+
+static void append_queued(Ks_EventManager_Impl* impl, EventTypeTable* table, const EventRecord& rec, const ks_byte* payload) {
+    if (rec.type_idx >= table->count || !table->slots[rec.type_idx]) return;
+    EventTypeData* data = table->slots[rec.type_idx];
+    EventQueue& q = data->queue;
+    if (q.count == 0) impl->pending_types.push_back(rec.type_idx);
+    q.any_keyed |= rec.keyed != 0;
+
+    // Last value wins. Thread queues are merged one after another, so when
+    // sequenced a record can arrive after a newer one and is dropped instead.
+    if (data->coalesce != KS_EVENT_COALESCE_NONE) {
+        ks_uint32& held = coalesce_slot(q, data->coalesce, rec);
+        if (held != KS_EVENT_NO_SLOT) {
+            bool has_seq = rec.seq != 0 && q.seqs.size() == q.count;
+            if (has_seq && rec.seq < q.seqs[held]) {
+                release_queued(data, payload);
+                return;
+            }
+            ks_byte* dst = q.bytes.data() + (ks_size)rec.size * held;
+            release_queued(data, dst);
+            memcpy(dst, payload, rec.size);
+            q.keys[held] = { rec.key, rec.keyed != 0 };
+            if (has_seq) q.seqs[held] = rec.seq;
+            return;
+        }
+        held = q.count;
+    }
+
+    q.bytes.insert(q.bytes.end(), payload, payload + rec.size);
+    if (rec.seq != 0) q.seqs.push_back(rec.seq);
+    q.keys.push_back({ rec.key, rec.keyed != 0 });
+    q.count++;
+}
+
+// Restores publish order across threads: each type's payloads are sorted by
+// sequence number, and types are dispatched by their earliest event.
+static void sort_by_sequence(Ks_EventManager_Impl* impl, EventTypeTable* table) {
+    if (!impl->sequenced.load(std::memory_order_relaxed)) return;
+
+    for (uint32_t idx : impl->pending_types) {
+        EventQueue& q = table->slots[idx]->queue;
+        if (q.seqs.size() != q.count || std::is_sorted(q.seqs.begin(), q.seqs.end())) continue;
+
+        ks_size stride = payload_stride(table->slots[idx]);
+        impl->sort_order.resize(q.count);
+        std::iota(impl->sort_order.begin(), impl->sort_order.end(), 0u);
+        std::sort(impl->sort_order.begin(), impl->sort_order.end(), [&](ks_uint32 a, ks_uint32 b) { return q.seqs[a] < q.seqs[b]; });
+
+        impl->sort_scratch.resize(q.bytes.size());
+        impl->sort_keys.resize(q.count);
+        for (ks_uint32 i = 0; i < q.count; ++i) {
+            memcpy(impl->sort_scratch.data() + stride * i, q.bytes.data() + stride * impl->sort_order[i], stride);
+            impl->sort_keys[i] = q.keys[impl->sort_order[i]];
+        }
+        q.bytes.swap(impl->sort_scratch);
+        q.keys.swap(impl->sort_keys);
+        std::sort(q.seqs.begin(), q.seqs.end());
+    }
+
+    std::stable_sort(impl->pending_types.begin(), impl->pending_types.end(), [&](uint32_t a, uint32_t b) {
+        const EventQueue& qa = table->slots[a]->queue;
+        const EventQueue& qb = table->slots[b]->queue;
+        ks_uint64 sa = qa.seqs.empty() ? UINT64_MAX : qa.seqs[0];
+        ks_uint64 sb = qb.seqs.empty() ? UINT64_MAX : qb.seqs[0];
+        return sa < sb;
+    });
+}
+
+static void dispatch_pending(Ks_EventManager_Impl* impl) {
+    PublishScope scope(impl);
+    EventTypeTable* table = impl->type_table.load();
+    if (!table) return;
+    if (impl->recording.load(std::memory_order_relaxed)) record_event(impl, nullptr, nullptr, KS_EVENT_LOG_DISPATCH, 0);
+
+    // Sync point: merge every thread's queue. Events enqueued from here on,
+    // including by the callbacks below, wait for the next dispatch.
     {
-        KS_PROFILE_SCOPE("EventManager::Callbacks");
-        for (const auto& sub : safe_subs) {
-            sub.callback(data_ptr, sub.user_data);
+        KS_PROFILE_SCOPE("EventManager::MergeQueues");
+        std::lock_guard<std::mutex> lock(impl->queue_mutex);
+        for (auto* queue : impl->thread_queues) {
+            drain_thread_queue(queue, [&](const EventRecord& rec, const ks_byte* payload) {
+                append_queued(impl, table, rec, payload);
+            });
+        }
+    }
+    sort_by_sequence(impl, table);
+
+    CallbackScope callbacks(impl);
+    for (uint32_t idx : impl->pending_types) {
+        EventTypeData* data = table->slots[idx];
+        EventQueue& q = data->queue;
+        ks_size stride = payload_stride(data);
+
+        const EventKeyIndex* index = q.any_keyed ? data->keyed.load() : nullptr;
+        for (ks_uint32 e = 0; index && e < q.count; ++e) {
+            if (!q.keys[e].keyed) continue;
+            const EventKeyBucket* bucket = find_key_bucket(index, q.keys[e].key);
+            const EventSubscriberList* keyed = bucket ? bucket->subs.load() : nullptr;
+            const ks_byte* payload = q.bytes.data() + stride * e;
+            for_each_subscriber(keyed, [&](const EventSubscriber& sub) { invoke_subscriber(sub, payload); });
+        }
+
+        for_each_subscriber(data->subscribers.load(), [&](const EventSubscriber& sub) {
+            if (sub.batch_callback) {
+                sub.batch_callback(q.bytes.data(), q.count, sub.user_data);
+                return;
+            }
+            for (ks_uint32 e = 0; e < q.count; ++e) {
+                sub.callback(q.bytes.data() + stride * e, sub.user_data);
+            }
+            });
+
+        if (data->release) {
+            for (ks_uint32 e = 0; e < q.count; ++e) release_queued(data, q.bytes.data() + stride * e);
         }
+
+        q.bytes.clear();
+        q.seqs.clear();
+        q.keys.clear();
+        q.count = 0;
+        q.any_keyed = false;
+        q.latest_slot = KS_EVENT_NO_SLOT;
+        q.slot_by_key.clear();
     }
+
+    impl->pending_types.clear();
 }
 
-KS_API void ks_event_manager_emit(Ks_EventManager em, Ks_Handle signal_handle){
-    ks_event_manager_publish(em, signal_handle, nullptr);
-}
\ No newline at end of file
+KS_API void ks_event_manager_dispatch_queued(Ks_EventManager em) {
+    KS_PROFILE_SCOPE("EventManager::DispatchQueued");
+    auto* impl = (Ks_EventManager_Impl*)em;
+    if (impl->dispatching) return;
+
+    impl->dispatching = true;
+    dispatch_pending(impl);
+    impl->dispatching = false;
+
+    // Pump point: whatever the last publish could not reclaim (it lost the
+    // mutex to a writer) is freed here, once per frame at the latest.
+    if (impl->has_retired.load()) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        reclaim_retired(impl);
+    }
+}
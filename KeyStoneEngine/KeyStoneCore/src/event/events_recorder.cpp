@@ -0,0 +1,308 @@
+#include "../../include/event/events_recorder.h"
+#include "../../include/core/reflection.h"
+#include "../../include/core/log.h"
+#include "../../include/core/error.h"
+#include "../../include/core/core_errors.h"
+#include "../../include/profiler/profiler.h"
+#include "../../include/memory/memory.h"
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <string.h>
+
+static constexpr ks_uint32 KS_EVENT_LOG_MAGIC = 0x4C45534B; // "KSEL"
+static constexpr ks_uint32 KS_EVENT_LOG_VERSION = 1;
+static constexpr ks_uint32 KS_EVENT_LOG_NO_TYPE = 0xFFFFFFFF;
+
+struct EventLogType {
+    std::string name;
+    ks_uint32 size;
+    bool has_payload;
+};
+
+struct EventLogRecord {
+    ks_uint32 type;
+    ks_uint32 flags;
+    ks_uint64 time_ns;
+    ks_uint64 key;
+    ks_uint32 size;
+    ks_uint32 reserved;
+};
+
+struct EventLogNameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+// Records are packed back to back, each followed by its payload padded to
+// 8 bytes. A saved log is this buffer behind the type table, so loading
+// and replaying never re-encode anything.
+struct Ks_EventLog_Impl {
+    std::vector<EventLogType> types;
+    std::unordered_map<std::string, ks_uint32, EventLogNameHash, std::equal_to<>> type_by_name;
+    std::vector<ks_byte> records;
+    ks_size count = 0;
+    ks_uint64 last_ns = 0;
+    ks_uint64 origin_ns = 0;
+    bool started = false;
+};
+
+static ks_size record_stride(const EventLogRecord& rec) {
+    return sizeof(EventLogRecord) + ((rec.size + 7) & ~(ks_size)7);
+}
+
+// Only value types can be stored as raw bytes: anything holding a pointer,
+// a string or an unreflected handle would be meaningless on replay.
+static bool is_pointer_free(const Ks_Type_Info* info, int depth = 0) {
+    if (!info || depth > 8) return false;
+    if (info->kind == KS_META_ENUM) return true;
+    if (info->kind != KS_META_STRUCT && info->kind != KS_META_UNION) return false;
+
+    for (ks_size i = 0; i < info->field_count; ++i) {
+        const Ks_Field_Info& f = info->fields[i];
+        if (f.ptr_depth > 0 || f.is_function_ptr) return false;
+
+        switch (f.type) {
+        case KS_TYPE_CSTRING:
+        case KS_TYPE_PTR:
+        case KS_TYPE_LIGHTUSERDATA:
+        case KS_TYPE_SCRIPT_TABLE:
+        case KS_TYPE_SCRIPT_FUNCTION:
+        case KS_TYPE_SCRIPT_COROUTINE:
+        case KS_TYPE_SCRIPT_ANY:
+            return false;
+        case KS_TYPE_USERDATA:
+            if (!is_pointer_free(ks_reflection_get_type(f.type_str), depth + 1)) return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+static ks_uint32 log_type_id(Ks_EventLog_Impl* log, ks_str name) {
+    auto it = log->type_by_name.find(std::string_view(name));
+    if (it != log->type_by_name.end()) return it->second;
+
+    const Ks_Type_Info* info = ks_reflection_get_type(name);
+    ks_uint32 id = (ks_uint32)log->types.size();
+    log->types.push_back({ name, info ? (ks_uint32)info->size : 0, is_pointer_free(info) });
+    log->type_by_name.emplace(name, id);
+    return id;
+}
+
+KS_API Ks_EventLog ks_event_log_create(void) {
+    void* mem = ks_alloc_debug(sizeof(Ks_EventLog_Impl), KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEventLog");
+    return (Ks_EventLog)new(mem) Ks_EventLog_Impl();
+}
+
+KS_API void ks_event_log_destroy(Ks_EventLog log) {
+    if (!log) return;
+    auto* impl = (Ks_EventLog_Impl*)log;
+    impl->~Ks_EventLog_Impl();
+    ks_dealloc(impl);
+}
+
+KS_API ks_size ks_event_log_count(Ks_EventLog log) {
+    return log ? ((Ks_EventLog_Impl*)log)->count : 0;
+}
+
+KS_API ks_uint64 ks_event_log_duration_ns(Ks_EventLog log) {
+    return log ? ((Ks_EventLog_Impl*)log)->last_ns : 0;
+}
+
+KS_API ks_uint64 ks_event_log_now_ns(void) {
+    return (ks_uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+KS_API void ks_event_log_append(Ks_EventLog log, ks_str event_name, const void* data_ptr, ks_uint32 flags, ks_uint64 key) {
+    ks_event_log_append_at(log, ks_event_log_now_ns(), event_name, data_ptr, flags, key);
+}
+
+KS_API void ks_event_log_append_at(Ks_EventLog log, ks_uint64 time_ns, ks_str event_name, const void* data_ptr, ks_uint32 flags, ks_uint64 key) {
+    auto* impl = (Ks_EventLog_Impl*)log;
+    if (!impl) return;
+
+    if (!impl->started) {
+        impl->origin_ns = time_ns;
+        impl->started = true;
+    }
+
+    EventLogRecord rec = { KS_EVENT_LOG_NO_TYPE, flags, 0, key, 0, 0 };
+    rec.time_ns = std::max(time_ns > impl->origin_ns ? time_ns - impl->origin_ns : 0, impl->last_ns);
+    if (event_name) {
+        rec.type = log_type_id(impl, event_name);
+        const EventLogType& type = impl->types[rec.type];
+        if (data_ptr && type.has_payload) rec.size = type.size;
+    }
+
+    ks_size offset = impl->records.size();
+    impl->records.resize(offset + record_stride(rec));
+    memcpy(impl->records.data() + offset, &rec, sizeof(rec));
+    if (rec.size > 0) memcpy(impl->records.data() + offset + sizeof(rec), data_ptr, rec.size);
+
+    impl->count++;
+    impl->last_ns = rec.time_ns;
+}
+
+template<typename T>
+static void log_put(std::vector<ks_byte>& out, const T& value) {
+    const ks_byte* bytes = (const ks_byte*)&value;
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static bool log_get(const ks_byte* in, ks_size size, ks_size& pos, T& value) {
+    if (sizeof(T) > size - pos) return false;
+    memcpy(&value, in + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+KS_API void* ks_event_log_save(Ks_EventLog log, ks_size* out_size) {
+    if (out_size) *out_size = 0;
+    auto* impl = (Ks_EventLog_Impl*)log;
+    if (!impl) return nullptr;
+
+    std::vector<ks_byte> header;
+    log_put(header, KS_EVENT_LOG_MAGIC);
+    log_put(header, KS_EVENT_LOG_VERSION);
+    log_put(header, (ks_uint32)impl->types.size());
+    log_put(header, (ks_uint64)impl->count);
+    log_put(header, (ks_uint64)impl->records.size());
+    for (const EventLogType& type : impl->types) {
+        log_put(header, (ks_uint32)type.name.size());
+        header.insert(header.end(), type.name.begin(), type.name.end());
+        log_put(header, type.size);
+        log_put(header, (ks_uint32)type.has_payload);
+    }
+
+    ks_size total = header.size() + impl->records.size();
+    auto* result = (ks_byte*)ks_alloc_debug(total, KS_LT_USER_MANAGED, KS_TAG_INTERNAL_DATA, "KsEventLogData");
+    memcpy(result, header.data(), header.size());
+    if (!impl->records.empty()) memcpy(result + header.size(), impl->records.data(), impl->records.size());
+    if (out_size) *out_size = total;
+    return result;
+}
+
+KS_API ks_no_ret ks_event_log_free(void* data) {
+    if (data) ks_dealloc(data);
+}
+
+KS_API Ks_EventLog ks_event_log_load(const void* data, ks_size size) {
+    if (!data) return nullptr;
+    const ks_byte* in = (const ks_byte*)data;
+    ks_size pos = 0;
+
+    auto corrupt = [](const char* what) -> Ks_EventLog {
+        ks_epush_fmt(KS_ERROR_LEVEL_BASE, "Core", "EventLog", KS_ERROR_INVALID_ARGUMENT, "Cannot load event log: %s", what);
+        return nullptr;
+    };
+
+    ks_uint32 magic = 0, version = 0, type_count = 0;
+    ks_uint64 count = 0, records_size = 0;
+    if (!log_get(in, size, pos, magic) || magic != KS_EVENT_LOG_MAGIC ||
+        !log_get(in, size, pos, version) || version != KS_EVENT_LOG_VERSION ||
+        !log_get(in, size, pos, type_count) || !log_get(in, size, pos, count) ||
+        !log_get(in, size, pos, records_size)) {
+        return corrupt("invalid header");
+    }
+
+    if (type_count > (size - pos) / (sizeof(ks_uint32) * 3)) return corrupt("truncated type table");
+
+    std::vector<EventLogType> types(type_count);
+    for (EventLogType& type : types) {
+        ks_uint32 name_len = 0, has_payload = 0;
+        if (!log_get(in, size, pos, name_len) || name_len > size - pos) return corrupt("truncated type table");
+        type.name.assign((const char*)in + pos, name_len);
+        pos += name_len;
+        if (!log_get(in, size, pos, type.size) || !log_get(in, size, pos, has_payload)) return corrupt("truncated type table");
+        type.has_payload = has_payload != 0;
+    }
+    if (records_size != size - pos) return corrupt("record section size mismatch");
+
+    // Validate every record up front so replay can walk the buffer blindly.
+    ks_size end = pos + (ks_size)records_size;
+    ks_uint64 seen = 0;
+    ks_uint64 last_ns = 0;
+    for (ks_size p = pos; p < end; ++seen) {
+        EventLogRecord rec;
+        if (sizeof(rec) > end - p) return corrupt("truncated record");
+        memcpy(&rec, in + p, sizeof(rec));
+        bool typed = rec.type != KS_EVENT_LOG_NO_TYPE;
+        if ((typed && rec.type >= type_count) || (rec.size != 0 && (!typed || rec.size != types[rec.type].size)) ||
+            record_stride(rec) > end - p) {
+            return corrupt("invalid record");
+        }
+        p += record_stride(rec);
+        last_ns = rec.time_ns;
+    }
+    if (seen != count) return corrupt("record count mismatch");
+
+    auto* impl = (Ks_EventLog_Impl*)ks_event_log_create();
+    impl->types = std::move(types);
+    for (ks_uint32 i = 0; i < type_count; ++i) impl->type_by_name.emplace(impl->types[i].name, i);
+    impl->records.assign(in + pos, in + end);
+    impl->count = (ks_size)count;
+    impl->last_ns = last_ns;
+    impl->started = true;
+    return (Ks_EventLog)impl;
+}
+
+KS_API ks_size ks_event_log_replay(Ks_EventLog log, Ks_EventManager em, Ks_Event_Replay_Speed speed) {
+    KS_PROFILE_SCOPE("EventLog::Replay");
+    auto* impl = (Ks_EventLog_Impl*)log;
+    if (!impl || !em) return 0;
+
+    std::vector<Ks_Handle> handles(impl->types.size(), KS_INVALID_HANDLE);
+    for (ks_size i = 0; i < impl->types.size(); ++i) {
+        const EventLogType& type = impl->types[i];
+        Ks_Handle h = ks_event_manager_get_event_handle(em, type.name.c_str());
+        const Ks_Type_Info* info = ks_reflection_get_type(type.name.c_str());
+        if (h == KS_INVALID_HANDLE || !info || info->size != type.size) {
+            KS_LOG_WARN("[EventLog] Skipping '%s': not registered with a matching layout.", type.name.c_str());
+            continue;
+        }
+        if (type.has_payload) handles[i] = h;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ks_size replayed = 0;
+    const ks_byte* p = impl->records.data();
+    const ks_byte* end = p + impl->records.size();
+
+    while (p < end) {
+        EventLogRecord rec;
+        memcpy(&rec, p, sizeof(rec));
+        const void* payload = rec.size > 0 ? p + sizeof(rec) : nullptr;
+        p += record_stride(rec);
+
+        if (speed == KS_EVENT_REPLAY_ORIGINAL) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(rec.time_ns));
+        }
+
+        if (rec.flags & KS_EVENT_LOG_DISPATCH) {
+            ks_event_manager_dispatch_queued(em);
+            continue;
+        }
+        if (rec.type == KS_EVENT_LOG_NO_TYPE || handles[rec.type] == KS_INVALID_HANDLE) continue;
+
+        Ks_Handle h = handles[rec.type];
+        bool keyed = (rec.flags & KS_EVENT_LOG_KEYED) != 0;
+        if (rec.flags & KS_EVENT_LOG_QUEUED) {
+            if (keyed) ks_event_manager_enqueue_keyed(em, h, rec.key, payload, rec.size);
+            else ks_event_manager_enqueue(em, h, payload, rec.size);
+        }
+        else {
+            if (keyed) ks_event_manager_publish_keyed(em, h, rec.key, payload);
+            else ks_event_manager_publish(em, h, payload);
+        }
+        replayed++;
+    }
+    return replayed;
+}
@@ -35,6 +35,18 @@ void text_destroy(Ks_AssetData data) {
     ks_dealloc(data);
 }
 
+static ks_size my_asset_size(Ks_AssetData data) {
+    return sizeof(MyCAsset);
+}
+
+// Size functions run outside the manager's lock, so they may call back into it.
+static Ks_AssetsManager g_measured_am = nullptr;
+
+static ks_size reentrant_asset_size(Ks_AssetData asset) {
+    ks_assets_manager_get_cache_usage(g_measured_am);
+    return my_asset_size(asset);
+}
+
 static Ks_AssetsManager create_test_env() {
     Ks_AssetsManager am = ks_assets_manager_create();
 
@@ -83,7 +95,7 @@ TEST_CASE("C API: Assets Manager") {
 
     SUBCASE("Hot Reloading System") {
         Ks_AssetsManager am = ks_assets_manager_create();
-        Ks_IAsset interface;
+        Ks_IAsset interface = {};
         interface.load_from_file_fn = text_load_file;
         interface.load_from_data_fn = nullptr;
         interface.destroy_fn = text_destroy;
@@ -149,6 +161,73 @@ TEST_CASE("C API: Assets Manager") {
         ks_assets_manager_destroy(am);
     }
 
+    SUBCASE("Stale Handles Stay Invalid") {
+        Ks_AssetsManager am = create_test_env();
+
+        Ks_Handle first = ks_assets_manager_load_asset_from_file(am, "MyCAsset", "churn", "churn.png");
+        ks_assets_manager_asset_release(am, first);
+
+        bool aliased = false;
+        for (int i = 0; i < 2000; ++i) {
+            Ks_Handle h = ks_assets_manager_load_asset_from_file(am, "MyCAsset", "churn", "churn.png");
+            aliased |= h == first;
+            aliased |= ks_assets_is_handle_valid(am, first) == ks_true;
+            ks_assets_manager_asset_release(am, h);
+        }
+        CHECK_FALSE(aliased);
+        ks_assets_manager_destroy(am);
+    }
+
+    SUBCASE("Released Asset Cache") {
+        Ks_AssetsManager am = ks_assets_manager_create();
+
+        Ks_IAsset interface = {};
+        interface.load_from_file_fn = my_asset_load_file;
+        interface.destroy_fn = my_asset_destroy;
+        CHECK_FALSE(ks_assets_manager_set_asset_size_fn(am, "CachedAsset", my_asset_size));
+        ks_assets_manager_register_asset_type(am, "CachedAsset", interface);
+        CHECK(ks_assets_manager_set_asset_size_fn(am, "CachedAsset", my_asset_size));
+        ks_assets_manager_set_cache_budget(am, sizeof(MyCAsset) * 2);
+
+        Ks_Handle atlas = ks_assets_manager_load_asset_from_file(am, "CachedAsset", "ui_atlas", "atlas.png");
+        MyCAsset* atlas_data = (MyCAsset*)ks_assets_manager_get_data(am, atlas);
+        ks_assets_manager_asset_release(am, atlas);
+
+        CHECK(ks_assets_manager_get_cache_usage(am) == sizeof(MyCAsset));
+        CHECK(ks_assets_manager_get_ref_count(am, atlas) == 0);
+
+        Ks_Handle again = ks_assets_manager_load_asset_from_file(am, "CachedAsset", "ui_atlas", "atlas.png");
+        CHECK(again == atlas);
+        CHECK(ks_assets_manager_get_data(am, again) == atlas_data);
+        CHECK(ks_assets_manager_get_ref_count(am, again) == 1);
+        CHECK(ks_assets_manager_get_cache_usage(am) == 0);
+        ks_assets_manager_asset_release(am, again);
+
+        Ks_Handle click = ks_assets_manager_load_asset_from_file(am, "CachedAsset", "click", "click.wav");
+        Ks_Handle music = ks_assets_manager_load_asset_from_file(am, "CachedAsset", "music", "music.ogg");
+        ks_assets_manager_asset_release(am, click);
+        ks_assets_manager_asset_release(am, music);
+
+        CHECK(ks_assets_is_handle_valid(am, atlas) == ks_false);
+        CHECK(ks_assets_is_handle_valid(am, click) == ks_true);
+        CHECK(ks_assets_is_handle_valid(am, music) == ks_true);
+
+        ks_assets_manager_set_cache_budget(am, 0);
+        CHECK(ks_assets_manager_get_cache_usage(am) == 0);
+        CHECK(ks_assets_is_handle_valid(am, music) == ks_false);
+
+        g_measured_am = am;
+        ks_assets_manager_set_asset_size_fn(am, "CachedAsset", reentrant_asset_size);
+        ks_assets_manager_set_cache_budget(am, sizeof(MyCAsset));
+        Ks_Handle icon = ks_assets_manager_load_asset_from_file(am, "CachedAsset", "icon", "icon.png");
+        ks_assets_manager_asset_release(am, icon);
+        CHECK(ks_assets_manager_get_cache_usage(am) == sizeof(MyCAsset));
+        CHECK(ks_assets_manager_reload_asset(am, icon) == ks_true);
+        CHECK(ks_assets_manager_get_cache_usage(am) == sizeof(MyCAsset));
+
+        ks_assets_manager_destroy(am);
+    }
+
     SUBCASE("VFS Integration & Path Resolution") {
         Ks_AssetsManager am = create_test_env();
         ks_vfs_init();
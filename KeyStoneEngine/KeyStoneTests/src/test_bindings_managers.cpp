@@ -122,6 +122,147 @@ TEST_CASE("Bindings: Managers Integration") {
         ks_event_manager_destroy(em);
     }
 
+    SUBCASE("Event Manager: Lua Coalesced Enqueue") {
+        Ks_EventManager em = ks_event_manager_create();
+        ks_event_manager_lua_bind(em, ctx);
+
+        const char* script = R"(
+            local moved = events.register("LuaEntityMoved", { x = types.INT }, { coalesce = "per_key" })
+            local calls, sum = 0, 0
+            events.subscribe(moved, function(evt)
+                calls = calls + 1
+                sum = sum + evt.x
+            end)
+
+            for i = 1, 100 do
+                events.enqueue(moved, { x = i }, 1)
+                events.enqueue(moved, { x = i * 2 }, 2)
+            end
+            events.dispatch()
+            verify_results(calls, sum)
+        )";
+
+        Ks_Script_Function_Call_Result res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(g_res_int == 2);
+        CHECK(g_res_float == doctest::Approx(300.0f));
+
+        ks_event_manager_destroy(em);
+    }
+
+    SUBCASE("Event Manager: Lua Enqueue Table To Native Event") {
+        Ks_EventManager em = ks_event_manager_create();
+        ks_event_manager_lua_bind(em, ctx);
+
+        Ks_Handle h = ks_event_manager_register_type(em, "NativeTestEvent");
+        static int s_native_calls = 0;
+        s_native_calls = 0;
+        ks_event_manager_subscribe(em, h, [](Ks_EventData, void*) { s_native_calls++; }, nullptr);
+
+        const char* script = R"(
+            events.enqueue("NativeTestEvent", { id = 5, value = 1.5 })
+            events.dispatch()
+        )";
+
+        Ks_Script_Function_Call_Result res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(s_native_calls == 0);
+
+        ks_event_manager_destroy(em);
+    }
+
+    SUBCASE("Event Manager: Packed Lua Layout -> C++ Subscribe") {
+        Ks_EventManager em = ks_event_manager_create();
+        ks_event_manager_lua_bind(em, ctx);
+
+        const char* script = R"(
+            hit_e = events.register("LuaPackedHit", { target = types.INT, amount = types.FLOAT, crit = types.BOOL })
+            events.subscribe(hit_e, function(evt)
+                verify_results(evt.target, evt.amount)
+            end)
+        )";
+        Ks_Script_Function_Call_Result res = ks_script_do_cstring(ctx, script);
+        REQUIRE(ks_script_call_succeded(ctx, res));
+
+        const Ks_Type_Info* info = ks_reflection_get_type("LuaPackedHit");
+        REQUIRE(info != nullptr);
+        REQUIRE(info->field_count == 3);
+        CHECK(info->size == 12);
+
+        struct PackedHitCheck { const Ks_Type_Info* info; int target; float amount; bool crit; int calls; };
+        PackedHitCheck check = { info, 0, 0.0f, false, 0 };
+        Ks_Handle hit_e = ks_event_manager_get_event_handle(em, "LuaPackedHit");
+        ks_event_manager_subscribe(em, hit_e, [](Ks_EventData data, void* ud) {
+            auto* c = (PackedHitCheck*)ud;
+            const ks_byte* bytes = (const ks_byte*)data;
+            for (ks_size i = 0; i < c->info->field_count; ++i) {
+                const Ks_Field_Info& f = c->info->fields[i];
+                if (strcmp(f.name, "target") == 0) memcpy(&c->target, bytes + f.offset, sizeof(int));
+                if (strcmp(f.name, "amount") == 0) memcpy(&c->amount, bytes + f.offset, sizeof(float));
+                if (strcmp(f.name, "crit") == 0) c->crit = bytes[f.offset] != 0;
+            }
+            c->calls++;
+        }, &check);
+
+        res = ks_script_do_cstring(ctx, R"(
+            events.publish(hit_e, { target = 7, amount = 2.5, crit = true })
+            events.publish(hit_e, { target = "seven", amount = 1.0, crit = false })
+            events.publish(hit_e, { target = 1 << 40, amount = 1.0, crit = false })
+        )");
+        CHECK(ks_script_call_succeded(ctx, res));
+
+        CHECK(check.calls == 1);
+        CHECK(check.target == 7);
+        CHECK(check.amount == doctest::Approx(2.5f));
+        CHECK(check.crit);
+        CHECK(g_res_int == 7);
+        CHECK(g_res_float == doctest::Approx(2.5f));
+
+        // Lua subscribers of a Lua publish get the published table itself.
+        res = ks_script_do_cstring(ctx, R"(
+            local payload = { target = 3, amount = 0.5, crit = false }
+            local same = false
+            local sub = events.subscribe(hit_e, function(evt) same = rawequal(evt, payload) end)
+            events.publish(hit_e, payload)
+            events.unsubscribe(sub)
+            verify_results(same and 1 or 0, 0)
+        )");
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(check.calls == 2);
+        CHECK(check.target == 3);
+        CHECK(g_res_int == 1);
+
+        ks_event_manager_destroy(em);
+    }
+
+    SUBCASE("Event Manager: Retyped Packed Layout Stays Table-Backed") {
+        Ks_EventManager em = ks_event_manager_create();
+        ks_event_manager_lua_bind(em, ctx);
+        Ks_Script_Function_Call_Result res = ks_script_do_cstring(ctx, R"(
+            events.register("LuaRetyped", { value = types.INT })
+        )");
+        REQUIRE(ks_script_call_succeded(ctx, res));
+
+        // Same name, size and offset, but the field changed type: the
+        // reflected layout cannot describe it, so payloads stay tables.
+        Ks_EventManager retyped = ks_event_manager_create();
+        ks_event_manager_lua_bind(retyped, ctx);
+        res = ks_script_do_cstring(ctx, R"(
+            local e = events.register("LuaRetyped", { value = types.FLOAT })
+            local kind, value
+            events.subscribe(e, function(evt) kind, value = type(evt), evt.value end)
+            events.enqueue(e, { value = 1.5 })
+            events.dispatch()
+            verify_results(kind == "table" and 1 or 0, value)
+        )");
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(g_res_int == 1);
+        CHECK(g_res_float == doctest::Approx(1.5f));
+
+        ks_event_manager_destroy(retyped);
+        ks_event_manager_destroy(em);
+    }
+
     SUBCASE("Assets Manager Binding") {
         Ks_JobManager jm = ks_job_manager_create();
         Ks_AssetsManager am = ks_assets_manager_create();
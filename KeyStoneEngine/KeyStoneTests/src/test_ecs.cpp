@@ -1,6 +1,9 @@
 #include <doctest/doctest.h>
 #include <keystone.h>
 #include <string.h>
+#include <atomic>
+#include <vector>
+#include <algorithm>
 
 struct Position { float x, y; };
 struct Velocity { float x, y; };
@@ -61,6 +64,72 @@ void QueryCallback(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
     (*counter)++;
 }
 
+struct CmdJobData {
+    Ks_Ecs_World world;
+    Ks_Component position;
+    Ks_Entity victim;
+    int spawn_count;
+    int job_index;
+};
+
+void CmdRecordJob(Ks_Payload payload) {
+    CmdJobData* data = (CmdJobData*)payload.data;
+    ks_ecs_cmd_set_sort_key((ks_uint64)data->job_index);
+    for (int i = 0; i < data->spawn_count; ++i) {
+        Ks_Entity e = ks_ecs_cmd_create(data->world);
+        Position p = { (float)(data->job_index * data->spawn_count + i + 1), 0.0f };
+        ks_ecs_cmd_set(data->world, e, data->position, &p);
+    }
+    ks_ecs_cmd_destroy(data->world, data->victim);
+}
+
+struct CmdOrderData {
+    Ks_Component position;
+    std::vector<std::pair<Ks_Entity, float>> seen;
+};
+
+void CmdOrderCallback(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
+    CmdOrderData* data = (CmdOrderData*)user_data;
+    const Position* p = (const Position*)ks_ecs_get_component_by_id(world, entity, data->position);
+    data->seen.push_back({ entity, p->x });
+}
+
+void IntegrateIterCallback(Ks_Ecs_Iter* it) {
+    Position* p = ks_ecs_iter_field_t(it, Position, 0);
+    const Velocity* v = ks_ecs_iter_field_t(it, const Velocity, 1);
+    int* calls = (int*)it->user_data;
+    (*calls)++;
+
+    for (int i = 0; i < it->count; ++i) {
+        p[i].x += v[i].x;
+        p[i].y += v[i].y;
+    }
+}
+
+void SumIterCallback(Ks_Ecs_Iter* it) {
+    SystemTestData* data = (SystemTestData*)it->user_data;
+    const Position* p = ks_ecs_iter_field_t(it, const Position, 0);
+
+    CHECK(ks_ecs_iter_field_size(it, 0) == sizeof(Position));
+    CHECK(ks_ecs_iter_field_is_self(it, 0));
+
+    for (int i = 0; i < it->count; ++i) {
+        data->entity_count++;
+        data->sum_x += p[i].x;
+    }
+}
+
+void ParallelIntegrateCallback(Ks_Ecs_Iter* it) {
+    Position* p = ks_ecs_iter_field_t(it, Position, 0);
+    const Velocity* v = ks_ecs_iter_field_t(it, const Velocity, 1);
+    std::atomic<int>* processed = (std::atomic<int>*)it->user_data;
+
+    for (int i = 0; i < it->count; ++i) {
+        p[i].x += v[i].x;
+    }
+    processed->fetch_add(it->count);
+}
+
 #define ks_str(...) #__VA_ARGS__
 
 
@@ -92,6 +161,39 @@ TEST_CASE("ECS System Advanced Features") {
         ks_ecs_destroy_world(world);
     }
 
+    SUBCASE("Component IDs") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+        Ks_Entity e = ks_ecs_create_entity(world, "Hero");
+
+        Ks_Component pos_id = ks_ecs_component_id(world, ks_type_id(Position));
+        CHECK(pos_id != 0);
+        CHECK(ks_ecs_component_id(world, ks_type_id(Position)) == pos_id);
+
+        Position p = { 3, 4 };
+        ks_ecs_set_component_by_id(world, e, pos_id, &p);
+
+        CHECK(ks_ecs_has_component_by_id(world, e, pos_id));
+        CHECK(ks_ecs_has_component(world, e, ks_type_id(Position)));
+
+        const Position* get_p = (const Position*)ks_ecs_get_component_by_id(world, e, pos_id);
+        CHECK(get_p != nullptr);
+        CHECK(get_p->y == 4);
+
+        Position* mut_p = (Position*)ks_ecs_get_component_mut_by_id(world, e, pos_id);
+        mut_p->y = 8;
+        CHECK(((const Position*)ks_ecs_get_component(world, e, ks_type_id(Position)))->y == 8);
+
+        ks_ecs_remove_component_by_id(world, e, pos_id);
+        CHECK(ks_ecs_has_component_by_id(world, e, pos_id) == false);
+
+        ks_ecs_set_component_by_id(world, e, 0, &p);
+        ks_ecs_set_component_by_id(nullptr, e, pos_id, &p);
+        CHECK(ks_ecs_get_component_by_id(nullptr, e, pos_id) == nullptr);
+        CHECK(ks_ecs_has_component_by_id(world, e, pos_id) == false);
+
+        ks_ecs_destroy_world(world);
+    }
+
     SUBCASE("System Execution with Phases") {
         Ks_Ecs_World world = ks_ecs_create_world();
         Ks_Entity e1 = ks_ecs_create_entity(world, "E1");
@@ -125,6 +227,401 @@ TEST_CASE("ECS System Advanced Features") {
         ks_ecs_destroy_world(world);
     }
 
+    SUBCASE("Column Iteration") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        for (int i = 0; i < 4; ++i) {
+            Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+            Position p = { (float)i, 0.0f };
+            Velocity v = { 1.0f, 2.0f };
+            ks_ecs_set_component(world, e, ks_type_id(Position), &p);
+            ks_ecs_set_component(world, e, ks_type_id(Velocity), &v);
+        }
+
+        int calls = 0;
+        Ks_Entity sys = ks_ecs_create_system_iter(world, "IntegrateSys", "Position, Velocity", KS_PHASE_ON_UPDATE, IntegrateIterCallback, &calls);
+        CHECK(sys != 0);
+
+        ks_ecs_progress(world, 0.16f);
+        CHECK(calls == 1);
+
+        SystemTestData stats = { 0, 0.0f };
+        ks_ecs_run_query_iter(world, "Position", SumIterCallback, &stats);
+
+        CHECK(stats.entity_count == 4);
+        CHECK(stats.sum_x == doctest::Approx(0.0f + 1.0f + 2.0f + 3.0f + 4.0f));
+
+        ks_ecs_destroy_world(world);
+    }
+
+    SUBCASE("Parallel System on Job Pool") {
+        Ks_JobManager jobs = ks_job_manager_create();
+        Ks_Ecs_World world = ks_ecs_create_world();
+        ks_ecs_set_threads(world, jobs, 0);
+
+        const int entity_count = 1000;
+        for (int i = 0; i < entity_count; ++i) {
+            Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+            Position p = { 0.0f, 0.0f };
+            Velocity v = { 1.0f, 0.0f };
+            ks_ecs_set_component(world, e, ks_type_id(Position), &p);
+            ks_ecs_set_component(world, e, ks_type_id(Velocity), &v);
+        }
+
+        std::atomic<int> processed = 0;
+        ks_ecs_create_system_parallel(world, "ParallelMove", "Position, [in] Velocity", KS_PHASE_ON_UPDATE, ParallelIntegrateCallback, &processed);
+
+        ks_ecs_progress(world, 0.16f);
+        ks_ecs_progress(world, 0.16f);
+
+        CHECK(processed.load() == entity_count * 2);
+
+        SystemTestData stats = { 0, 0.0f };
+        ks_ecs_run_query_iter(world, "Position", SumIterCallback, &stats);
+        CHECK(stats.sum_x == doctest::Approx(entity_count * 2.0f));
+
+        ks_ecs_destroy_world(world);
+        ks_job_manager_destroy(jobs);
+    }
+
+    SUBCASE("Deferred Command Buffers") {
+        Ks_JobManager jobs = ks_job_manager_create();
+        Ks_Ecs_World world = ks_ecs_create_world();
+        Ks_Component pos_id = ks_ecs_component_id(world, ks_type_id(Position));
+
+        const int job_count = 8;
+        const int spawn_count = 50;
+
+        std::vector<Ks_Entity> victims;
+        for (int i = 0; i < job_count; ++i) {
+            Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+            Position p = { 0.0f, 0.0f };
+            ks_ecs_set_component_by_id(world, e, pos_id, &p);
+            victims.push_back(e);
+        }
+
+        std::vector<Ks_JobCounter> counters;
+        for (int i = 0; i < job_count; ++i) {
+            CmdJobData data = { world, pos_id, victims[i], spawn_count, i };
+            counters.push_back(ks_job_run(jobs, CmdRecordJob, &data, sizeof(data), ks_true, nullptr));
+        }
+        for (auto c : counters) ks_job_wait(jobs, c);
+
+        int count = 0;
+        ks_ecs_run_query(world, "Position", QueryCallback, &count);
+        CHECK(count == job_count);
+
+        ks_ecs_cmd_flush(world);
+
+        count = 0;
+        ks_ecs_run_query(world, "Position", QueryCallback, &count);
+        CHECK(count == job_count * spawn_count);
+        for (auto v : victims) CHECK_FALSE(ks_ecs_is_alive(world, v));
+
+        // Entities are created in sort key order, whatever thread ran the job.
+        CmdOrderData order = { pos_id, {} };
+        ks_ecs_run_query(world, "Position", CmdOrderCallback, &order);
+        std::sort(order.seen.begin(), order.seen.end());
+        for (size_t i = 0; i < order.seen.size(); ++i) {
+            CHECK(order.seen[i].second == doctest::Approx((float)(i + 1)));
+        }
+
+        Ks_Entity e = ks_ecs_cmd_create(world);
+        Position p = { 5.0f, 5.0f };
+        ks_ecs_cmd_set(world, e, pos_id, &p);
+        ks_ecs_cmd_remove(world, e, pos_id);
+        ks_ecs_progress(world, 0.016f);
+
+        count = 0;
+        ks_ecs_run_query(world, "Position", QueryCallback, &count);
+        CHECK(count == job_count * spawn_count);
+
+        ks_ecs_destroy_world(world);
+        ks_job_manager_destroy(jobs);
+    }
+
+    SUBCASE("Persistent Query") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        Ks_Ecs_Query q = ks_ecs_query_create(world, "Position");
+        REQUIRE(q != nullptr);
+
+        int count = 0;
+        ks_ecs_query_each(q, QueryCallback, &count);
+        CHECK(count == 0);
+
+        Position p = { 1, 1 };
+        Ks_Entity e1 = ks_ecs_create_entity(world, "P1");
+        Ks_Entity e2 = ks_ecs_create_entity(world, "P2");
+        ks_ecs_set_component(world, e1, ks_type_id(Position), &p);
+        ks_ecs_set_component(world, e2, ks_type_id(Position), &p);
+
+        for (int frame = 0; frame < 3; ++frame) {
+            count = 0;
+            ks_ecs_query_each(q, QueryCallback, &count);
+            CHECK(count == 2);
+        }
+
+        SystemTestData stats = { 0, 0.0f };
+        ks_ecs_query_iter(q, SumIterCallback, &stats);
+        CHECK(stats.entity_count == 2);
+        CHECK(stats.sum_x == doctest::Approx(2.0f));
+
+        ks_ecs_query_destroy(q);
+
+        ks_ecs_destroy_world(world);
+    }
+
+    SUBCASE("Bulk Entity Creation") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        const int n = 1000;
+        std::vector<Position> positions(n);
+        std::vector<Velocity> velocities(n);
+        for (int i = 0; i < n; ++i) {
+            positions[i] = { (float)i, 0.0f };
+            velocities[i] = { 1.0f, 2.0f };
+        }
+
+        Ks_Component ids[] = {
+            ks_ecs_component_id(world, ks_type_id(Position)),
+            ks_ecs_component_id(world, ks_type_id(Velocity))
+        };
+        const void* columns[] = { positions.data(), velocities.data() };
+
+        Ks_Entity_Range range = ks_ecs_create_entities(world, n, ids, 2, columns);
+        REQUIRE(range.count == n);
+        REQUIRE(range.entities != nullptr);
+
+        std::vector<Ks_Entity> created(range.entities, range.entities + range.count);
+        for (int i = 0; i < n; i += 111) {
+            const Position* p = (const Position*)ks_ecs_get_component_by_id(world, created[i], ids[0]);
+            const Velocity* v = (const Velocity*)ks_ecs_get_component_by_id(world, created[i], ids[1]);
+            REQUIRE(p != nullptr);
+            REQUIRE(v != nullptr);
+            CHECK(p->x == doctest::Approx((float)i));
+            CHECK(v->y == doctest::Approx(2.0f));
+        }
+
+        int count = 0;
+        ks_ecs_run_query(world, "Position, Velocity", QueryCallback, &count);
+        CHECK(count == n);
+
+        Ks_Entity_Range empty = ks_ecs_create_entities(world, 16, nullptr, 0, nullptr);
+        CHECK(empty.count == 16);
+
+        ks_ecs_destroy_world(world);
+    }
+
+    SUBCASE("Change Detection") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        std::vector<Ks_Entity> entities;
+        for (int i = 0; i < 10; ++i) {
+            Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+            Position p = { 1.0f, 0.0f };
+            ks_ecs_set_component(world, e, ks_type_id(Position), &p);
+            entities.push_back(e);
+        }
+
+        Ks_Ecs_Query q = ks_ecs_query_create_changed(world, "[in] Position");
+        REQUIRE(q != nullptr);
+
+        CHECK(ks_ecs_query_changed(q));
+        SystemTestData stats = { 0, 0.0f };
+        ks_ecs_query_iter_changed(q, SumIterCallback, &stats);
+        CHECK(stats.entity_count == 10);
+
+        CHECK_FALSE(ks_ecs_query_changed(q));
+        stats = { 0, 0.0f };
+        ks_ecs_query_iter_changed(q, SumIterCallback, &stats);
+        CHECK(stats.entity_count == 0);
+
+        Position* p = (Position*)ks_ecs_get_component_mut(world, entities[3], ks_type_id(Position));
+        p->x = 5.0f;
+        ks_ecs_modified(world, entities[3], ks_type_id(Position));
+
+        CHECK(ks_ecs_query_changed(q));
+        stats = { 0, 0.0f };
+        ks_ecs_query_iter_changed(q, SumIterCallback, &stats);
+        CHECK(stats.entity_count == 10);
+        CHECK(stats.sum_x == doctest::Approx(14.0f));
+
+        ks_ecs_query_destroy(q);
+        ks_ecs_destroy_world(world);
+    }
+
+    SUBCASE("World Snapshot") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        std::vector<Ks_Entity> entities;
+        for (int i = 0; i < 1000; ++i) {
+            Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+            Position p = { (float)i, 1.0f };
+            ks_ecs_set_component(world, e, ks_type_id(Position), &p);
+            if (i % 2 == 0) {
+                Velocity v = { 2.0f, 0.0f };
+                ks_ecs_set_component(world, e, ks_type_id(Velocity), &v);
+            }
+            entities.push_back(e);
+        }
+
+        Ks_Entity parent = ks_ecs_create_entity(world, "SnapParent");
+        Ks_Entity child = ks_ecs_create_entity(world, "SnapChild");
+        Position origin = { 0.0f, 0.0f };
+        ks_ecs_set_component(world, parent, ks_type_id(Position), &origin);
+        ks_ecs_set_component(world, child, ks_type_id(Position), &origin);
+        ks_ecs_add_child(world, parent, child);
+
+        ks_size size = 0;
+        void* snapshot = ks_ecs_snapshot_save(world, &size);
+        REQUIRE(snapshot != nullptr);
+        CHECK(size > 1000 * sizeof(Position));
+
+        Position moved = { -1.0f, -1.0f };
+        ks_ecs_set_component(world, entities[10], ks_type_id(Position), &moved);
+        ks_ecs_destroy_entity(world, entities[11]);
+        ks_ecs_remove_component(world, entities[12], ks_type_id(Velocity));
+        Ks_Entity extra = ks_ecs_create_entity(world, nullptr);
+        ks_ecs_set_component(world, extra, ks_type_id(Position), &moved);
+
+        // A truncated buffer is rejected before anything is deleted.
+        CHECK_FALSE(ks_ecs_snapshot_load(world, snapshot, size - 8));
+        CHECK(ks_ecs_is_alive(world, extra));
+
+        CHECK(ks_ecs_snapshot_load(world, snapshot, size));
+
+        int count = 0;
+        ks_ecs_run_query(world, "Position", QueryCallback, &count);
+        CHECK(count == 1002);
+        count = 0;
+        ks_ecs_run_query(world, "Position, Velocity", QueryCallback, &count);
+        CHECK(count == 500);
+
+        CHECK(ks_ecs_is_alive(world, entities[11]));
+        CHECK_FALSE(ks_ecs_is_alive(world, extra));
+
+        const Position* p = (const Position*)ks_ecs_get_component(world, entities[10], ks_type_id(Position));
+        REQUIRE(p != nullptr);
+        CHECK(p->x == doctest::Approx(10.0f));
+        CHECK(ks_ecs_has_component(world, entities[12], ks_type_id(Velocity)));
+
+        CHECK(ks_ecs_is_alive(world, child));
+        CHECK(ks_ecs_get_parent(world, child) == parent);
+        CHECK(strcmp(ks_ecs_get_name(world, parent), "SnapParent") == 0);
+        CHECK(strcmp(ks_ecs_get_name(world, child), "SnapChild") == 0);
+
+        CHECK_FALSE(ks_ecs_snapshot_load(world, snapshot, 6));
+
+        ks_ecs_snapshot_free(snapshot);
+        ks_ecs_destroy_world(world);
+    }
+
+    SUBCASE("System Stats") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        for (int i = 0; i < 20; ++i) {
+            Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+            Position p = { 0.0f, 0.0f };
+            Velocity v = { 1.0f, 1.0f };
+            ks_ecs_set_component(world, e, ks_type_id(Position), &p);
+            ks_ecs_set_component(world, e, ks_type_id(Velocity), &v);
+            if (i % 2 == 0) ks_ecs_set_component(world, e, ks_type_id(Health), &i);
+        }
+
+        int calls = 0;
+        Ks_Entity sys = ks_ecs_create_system_iter(world, "StatsMover", "Position, [in] Velocity", KS_PHASE_ON_UPDATE, IntegrateIterCallback, &calls);
+        ks_ecs_progress(world, 0.016f);
+        ks_ecs_progress(world, 0.016f);
+
+        Ks_Ecs_System_Stats stats;
+        REQUIRE(ks_ecs_get_system_stats(world, sys, &stats));
+        CHECK(strcmp(stats.name, "StatsMover") == 0);
+        CHECK(stats.invocations == 2);
+        CHECK(stats.table_count == 2);
+        CHECK(stats.entity_count == 20);
+        CHECK(stats.time_ms >= 0.0);
+        CHECK(stats.total_time_ms >= stats.max_time_ms);
+
+        CHECK(ks_ecs_get_all_system_stats(world, nullptr, 0) == 1);
+        Ks_Ecs_System_Stats all[4];
+        CHECK(ks_ecs_get_all_system_stats(world, all, 4) == 1);
+        CHECK(all[0].system == sys);
+
+        ks_ecs_reset_system_stats(world);
+        REQUIRE(ks_ecs_get_system_stats(world, sys, &stats));
+        CHECK(stats.invocations == 0);
+
+        ks_ecs_destroy_entity(world, sys);
+        CHECK_FALSE(ks_ecs_get_system_stats(world, sys, &stats));
+
+        ks_ecs_destroy_world(world);
+    }
+
+    SUBCASE("Spatial Index") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        Ks_Ecs_Spatial index = ks_ecs_spatial_create(world, ks_type_id(Position), 2.0f);
+        REQUIRE(index != nullptr);
+        CHECK(ks_ecs_spatial_create(world, ks_type_id(Health), 2.0f) == nullptr);
+
+        std::vector<Ks_Entity> grid;
+        for (int i = 0; i < 10; ++i) {
+            for (int j = 0; j < 10; ++j) {
+                Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+                Position p = { (float)i, (float)j };
+                ks_ecs_set_component(world, e, ks_type_id(Position), &p);
+                grid.push_back(e);
+            }
+        }
+        CHECK(ks_ecs_spatial_count(index) == 100);
+
+        Ks_Entity_Range near_origin = ks_ecs_spatial_query_radius(index, 0.0f, 0.0f, 0.0f, 1.5f);
+        CHECK(near_origin.count == 4);
+
+        Ks_Entity_Range box = ks_ecs_spatial_query_aabb(index, 2.0f, 2.0f, 0.0f, 4.0f, 4.0f, 0.0f);
+        CHECK(box.count == 9);
+
+        Ks_Entity_Range nearest = ks_ecs_spatial_query_nearest(index, 9.2f, 9.1f, 0.0f, 3);
+        REQUIRE(nearest.count == 3);
+        CHECK(nearest.entities[0] == grid[99]);
+
+        Velocity v = { 50.0f, 0.0f };
+        ks_ecs_set_component(world, grid[0], ks_type_id(Velocity), &v);
+        int calls = 0;
+        ks_ecs_create_system_iter(world, "Integrate", "Position, [in] Velocity", KS_PHASE_ON_UPDATE, IntegrateIterCallback, &calls);
+        ks_ecs_progress(world, 0.016f);
+
+        Ks_Entity_Range moved = ks_ecs_spatial_query_radius(index, 50.0f, 0.0f, 0.0f, 0.5f);
+        REQUIRE(moved.count == 1);
+        CHECK(moved.entities[0] == grid[0]);
+        CHECK(ks_ecs_spatial_query_radius(index, 0.0f, 0.0f, 0.0f, 0.5f).count == 0);
+
+        ks_ecs_destroy_entity(world, grid[0]);
+        CHECK(ks_ecs_spatial_count(index) == 99);
+        CHECK(ks_ecs_spatial_query_nearest(index, 50.0f, 0.0f, 0.0f, 1).entities[0] == grid[90]);
+
+        Position* raw = (Position*)ks_ecs_get_component_mut(world, grid[1], ks_type_id(Position));
+        raw->x = -20.0f;
+        ks_ecs_modified(world, grid[1], ks_type_id(Position));
+        CHECK(ks_ecs_spatial_query_radius(index, -20.0f, 1.0f, 0.0f, 0.5f).count == 1);
+
+        ks_ecs_spatial_destroy(index);
+        ks_ecs_destroy_world(world);
+
+        Ks_Ecs_World doomed = ks_ecs_create_world();
+        Ks_Ecs_Spatial orphan = ks_ecs_spatial_create(doomed, ks_type_id(Position), 2.0f);
+        Ks_Entity e = ks_ecs_create_entity(doomed, nullptr);
+        Position p = { 1.0f, 1.0f };
+        ks_ecs_set_component(doomed, e, ks_type_id(Position), &p);
+        CHECK(ks_ecs_spatial_count(orphan) == 1);
+
+        ks_ecs_destroy_world(doomed);
+        CHECK(ks_ecs_spatial_count(orphan) == 0);
+        CHECK(ks_ecs_spatial_query_radius(orphan, 1.0f, 1.0f, 0.0f, 5.0f).count == 0);
+        ks_ecs_spatial_destroy(orphan);
+    }
+
     SUBCASE("Hierarchy System") {
         Ks_Ecs_World world = ks_ecs_create_world();
 
@@ -171,6 +668,111 @@ TEST_CASE("ECS System Advanced Features") {
         ks_ecs_destroy_world(world);
     }
 
+    SUBCASE("Batch Prefab Instantiation") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+
+        Ks_Entity prefab = ks_ecs_create_prefab(world, "Bullet");
+        Position origin = { 1.0f, 2.0f };
+        ks_ecs_set_component(world, prefab, ks_type_id(Position), &origin);
+        CHECK(ks_ecs_is_prefab(world, prefab));
+
+        std::vector<Ks_Entity> bullets(1000);
+        Ks_Entity_Range range = ks_ecs_instantiate_n(world, prefab, 1000, bullets.data());
+        REQUIRE(range.count == 1000);
+        CHECK(range.entities == bullets.data());
+        CHECK_FALSE(ks_ecs_is_prefab(world, bullets[0]));
+
+        Position* p = (Position*)ks_ecs_get_component_mut(world, bullets[10], ks_type_id(Position));
+        REQUIRE(p != nullptr);
+        p->x = 9.0f;
+        CHECK(((const Position*)ks_ecs_get_component(world, bullets[11], ks_type_id(Position)))->x == doctest::Approx(1.0f));
+        CHECK(((const Position*)ks_ecs_get_component(world, prefab, ks_type_id(Position)))->x == doctest::Approx(1.0f));
+
+        int count = 0;
+        ks_ecs_run_query(world, "Position", QueryCallback, &count);
+        CHECK(count == 1000);
+
+        CHECK(ks_ecs_instantiate_n(world, prefab, 0, nullptr).count == 0);
+
+        ks_ecs_destroy_world(world);
+    }
+
+    SUBCASE("World Extraction") {
+        Ks_Ecs_World world = ks_ecs_create_world();
+        CHECK(ks_ecs_extract_acquire(world) == nullptr);
+
+        for (int i = 0; i < 8; ++i) {
+            Ks_Entity e = ks_ecs_create_entity(world, nullptr);
+            Position p = { (float)i, 0.0f };
+            Velocity v = { 1.0f, 0.0f };
+            ks_ecs_set_component(world, e, ks_type_id(Position), &p);
+            ks_ecs_set_component(world, e, ks_type_id(Velocity), &v);
+        }
+        Ks_Entity prefab = ks_ecs_create_prefab(world, "ExtractTemplate");
+        Position hidden = { 100.0f, 0.0f };
+        ks_ecs_set_component(world, prefab, ks_type_id(Position), &hidden);
+
+        int calls = 0;
+        ks_ecs_create_system_iter(world, "ExtractMove", "Position, Velocity", KS_PHASE_ON_UPDATE, IntegrateIterCallback, &calls);
+        ks_ecs_extract_register(world, ks_type_id(Position));
+
+        ks_ecs_progress(world, 0.16f);
+        Ks_Ecs_Extract_Frame frame = ks_ecs_extract_acquire(world);
+        REQUIRE(frame != nullptr);
+        CHECK(ks_ecs_extract_frame_index(frame) == 1);
+
+        Ks_Ecs_Extract_Column col;
+        CHECK_FALSE(ks_ecs_extract_get(frame, ks_type_id(Velocity), &col));
+        REQUIRE(ks_ecs_extract_get(frame, ks_type_id(Position), &col));
+        CHECK(col.count == 8);
+        CHECK(col.stride == sizeof(Position));
+
+        float sum = 0.0f;
+        const Position* pos = (const Position*)col.data;
+        for (int i = 0; i < col.count; ++i) sum += pos[i].x;
+        CHECK(sum == doctest::Approx(28.0f + 8.0f));
+
+        // The pinned frame stays stable while the simulation moves on.
+        ks_ecs_progress(world, 0.16f);
+        float pinned = 0.0f;
+        for (int i = 0; i < col.count; ++i) pinned += pos[i].x;
+        CHECK(pinned == doctest::Approx(sum));
+
+        Ks_Ecs_Extract_Frame latest = ks_ecs_extract_acquire(world);
+        CHECK(latest != frame);
+        CHECK(ks_ecs_extract_frame_index(latest) == 2);
+        ks_ecs_extract_release(latest);
+        ks_ecs_extract_release(frame);
+
+        ks_ecs_extract_set_auto(world, false);
+        ks_ecs_progress(world, 0.16f);
+        frame = ks_ecs_extract_acquire(world);
+        CHECK(ks_ecs_extract_frame_index(frame) == 2);
+        ks_ecs_extract_release(frame);
+
+        CHECK(ks_ecs_extract(world));
+        frame = ks_ecs_extract_acquire(world);
+        CHECK(ks_ecs_extract_frame_index(frame) == 3);
+
+        // With both frames pinned, extraction is skipped instead of blocking.
+        CHECK(ks_ecs_extract(world));
+        latest = ks_ecs_extract_acquire(world);
+        CHECK(ks_ecs_extract_frame_index(latest) == 4);
+        CHECK_FALSE(ks_ecs_extract(world));
+        Ks_Ecs_Extract_Frame again = ks_ecs_extract_acquire(world);
+        CHECK(again == latest);
+        ks_ecs_extract_release(again);
+        ks_ecs_extract_release(latest);
+
+        ks_ecs_extract_release(frame);
+        CHECK(ks_ecs_extract(world));
+        frame = ks_ecs_extract_acquire(world);
+        CHECK(ks_ecs_extract_frame_index(frame) == 5);
+        ks_ecs_extract_release(frame);
+
+        ks_ecs_destroy_world(world);
+    }
+
     SUBCASE("Singleton Components") {
         Ks_Ecs_World world = ks_ecs_create_world();
 
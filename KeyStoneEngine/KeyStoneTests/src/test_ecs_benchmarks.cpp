@@ -0,0 +1,259 @@
+#include <doctest/doctest.h>
+#include <keystone.h>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+
+// Skipped by default; run with: KeyStoneTests --no-skip -tc="ECS Benchmarks"
+// Every measurement is printed as one JSON object per line so CI can diff
+// runs and spot regressions in the wrapper layer over flecs.
+
+struct BenchPosition { float x, y; };
+struct BenchVelocity { float x, y; };
+
+static const int k_bench_sizes[] = { 1000, 100000, 1000000 };
+
+template<typename Func>
+static double bench_ms(Func&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static void bench_report(const char* bench, int entities, double ms) {
+    printf("{\"suite\":\"ecs\",\"bench\":\"%s\",\"entities\":%d,\"ms\":%.3f,\"ns_per_entity\":%.2f}\n",
+        bench, entities, ms, ms * 1e6 / (double)entities);
+    fflush(stdout);
+}
+
+static void bench_reflect() {
+    if (!ks_reflection_get_type(ks_type_id(BenchPosition))) {
+        ks_reflect_struct(BenchPosition,
+            ks_reflect_field(float, x),
+            ks_reflect_field(float, y)
+        );
+    }
+    if (!ks_reflection_get_type(ks_type_id(BenchVelocity))) {
+        ks_reflect_struct(BenchVelocity,
+            ks_reflect_field(float, x),
+            ks_reflect_field(float, y)
+        );
+    }
+}
+
+static std::vector<Ks_Entity> bench_populate(Ks_Ecs_World world, int n) {
+    Ks_Component ids[2] = {
+        ks_ecs_component_id(world, ks_type_id(BenchPosition)),
+        ks_ecs_component_id(world, ks_type_id(BenchVelocity))
+    };
+    std::vector<BenchPosition> pos(n, BenchPosition{ 0.0f, 0.0f });
+    std::vector<BenchVelocity> vel(n, BenchVelocity{ 1.0f, 1.0f });
+    const void* columns[2] = { pos.data(), vel.data() };
+
+    Ks_Entity_Range range = ks_ecs_create_entities(world, n, ids, 2, columns);
+    return std::vector<Ks_Entity>(range.entities, range.entities + range.count);
+}
+
+static void BenchEachCallback(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
+    BenchPosition* p = (BenchPosition*)ks_ecs_get_component_mut(world, entity, ks_type_id(BenchPosition));
+    p->x += 1.0f;
+}
+
+static void BenchIterCallback(Ks_Ecs_Iter* it) {
+    BenchPosition* p = ks_ecs_iter_field_t(it, BenchPosition, 0);
+    const BenchVelocity* v = ks_ecs_iter_field_t(it, const BenchVelocity, 1);
+    for (int i = 0; i < it->count; ++i) {
+        p[i].x += v[i].x;
+    }
+}
+
+static void BenchObserverCallback(Ks_Ecs_World world, Ks_Entity entity, void* user_data) {
+    (*(int*)user_data)++;
+}
+
+TEST_CASE("ECS Benchmarks" * doctest::skip()) {
+    ks_memory_init();
+    ks_reflection_init();
+    bench_reflect();
+
+    SUBCASE("Entity Creation & Destruction") {
+        for (int n : k_bench_sizes) {
+            Ks_Ecs_World world = ks_ecs_create_world();
+            std::vector<Ks_Entity> entities(n);
+
+            double ms = bench_ms([&]() {
+                BenchPosition p = { 0.0f, 0.0f };
+                for (int i = 0; i < n; ++i) {
+                    entities[i] = ks_ecs_create_entity(world, nullptr);
+                    ks_ecs_set_component(world, entities[i], ks_type_id(BenchPosition), &p);
+                }
+            });
+            bench_report("create_single", n, ms);
+
+            ms = bench_ms([&]() {
+                for (int i = 0; i < n; ++i) ks_ecs_destroy_entity(world, entities[i]);
+            });
+            bench_report("destroy_single", n, ms);
+
+            ms = bench_ms([&]() { entities = bench_populate(world, n); });
+            bench_report("create_bulk", n, ms);
+            CHECK((int)entities.size() == n);
+
+            ks_ecs_destroy_world(world);
+        }
+    }
+
+    SUBCASE("Snapshot Save & Load") {
+        for (int n : k_bench_sizes) {
+            Ks_Ecs_World world = ks_ecs_create_world();
+            bench_populate(world, n);
+
+            ks_size size = 0;
+            void* snapshot = nullptr;
+            double ms = bench_ms([&]() { snapshot = ks_ecs_snapshot_save(world, &size); });
+            bench_report("snapshot_save", n, ms);
+            REQUIRE(snapshot != nullptr);
+
+            bool loaded = false;
+            ms = bench_ms([&]() { loaded = ks_ecs_snapshot_load(world, snapshot, size); });
+            bench_report("snapshot_load", n, ms);
+            CHECK(loaded);
+
+            Ks_Ecs_World fresh = ks_ecs_create_world();
+            ms = bench_ms([&]() { loaded = ks_ecs_snapshot_load(fresh, snapshot, size); });
+            bench_report("snapshot_load_fresh", n, ms);
+            CHECK(loaded);
+
+            ks_ecs_snapshot_free(snapshot);
+            ks_ecs_destroy_world(fresh);
+            ks_ecs_destroy_world(world);
+        }
+    }
+
+    SUBCASE("Component Access By Name vs Id") {
+        for (int n : k_bench_sizes) {
+            Ks_Ecs_World world = ks_ecs_create_world();
+            std::vector<Ks_Entity> entities = bench_populate(world, n);
+            Ks_Component pos_id = ks_ecs_component_id(world, ks_type_id(BenchPosition));
+            BenchPosition p = { 2.0f, 3.0f };
+            float sum = 0.0f;
+
+            double ms = bench_ms([&]() {
+                for (Ks_Entity e : entities) sum += ((const BenchPosition*)ks_ecs_get_component(world, e, ks_type_id(BenchPosition)))->x;
+            });
+            bench_report("get_by_name", n, ms);
+
+            ms = bench_ms([&]() {
+                for (Ks_Entity e : entities) sum += ((const BenchPosition*)ks_ecs_get_component_by_id(world, e, pos_id))->x;
+            });
+            bench_report("get_by_id", n, ms);
+
+            ms = bench_ms([&]() {
+                for (Ks_Entity e : entities) ks_ecs_set_component(world, e, ks_type_id(BenchPosition), &p);
+            });
+            bench_report("set_by_name", n, ms);
+
+            ms = bench_ms([&]() {
+                for (Ks_Entity e : entities) ks_ecs_set_component_by_id(world, e, pos_id, &p);
+            });
+            bench_report("set_by_id", n, ms);
+
+            CHECK(sum == doctest::Approx(0.0f));
+            ks_ecs_destroy_world(world);
+        }
+    }
+
+    SUBCASE("Query Iteration: Per-Entity vs Columns") {
+        for (int n : k_bench_sizes) {
+            Ks_Ecs_World world = ks_ecs_create_world();
+            bench_populate(world, n);
+            Ks_Ecs_Query query = ks_ecs_query_create(world, "BenchPosition, [in] BenchVelocity");
+
+            double ms = bench_ms([&]() {
+                ks_ecs_run_query(world, "BenchPosition, [in] BenchVelocity", BenchEachCallback, nullptr);
+            });
+            bench_report("query_each_adhoc", n, ms);
+
+            ms = bench_ms([&]() { ks_ecs_query_each(query, BenchEachCallback, nullptr); });
+            bench_report("query_each_cached", n, ms);
+
+            ms = bench_ms([&]() { ks_ecs_query_iter(query, BenchIterCallback, nullptr); });
+            bench_report("query_iter_cached", n, ms);
+
+            ks_ecs_query_destroy(query);
+            ks_ecs_destroy_world(world);
+        }
+    }
+
+    SUBCASE("Observer Overhead") {
+        for (int n : k_bench_sizes) {
+            Ks_Ecs_World world = ks_ecs_create_world();
+            std::vector<Ks_Entity> entities = bench_populate(world, n);
+            BenchVelocity v = { 0.5f, 0.5f };
+
+            double ms = bench_ms([&]() {
+                for (Ks_Entity e : entities) ks_ecs_set_component(world, e, ks_type_id(BenchVelocity), &v);
+            });
+            bench_report("set_without_observer", n, ms);
+
+            int fired = 0;
+            ks_ecs_create_observer(world, KS_EVENT_ON_SET, ks_type_id(BenchVelocity), BenchObserverCallback, &fired);
+
+            ms = bench_ms([&]() {
+                for (Ks_Entity e : entities) ks_ecs_set_component(world, e, ks_type_id(BenchVelocity), &v);
+            });
+            bench_report("set_with_observer", n, ms);
+            CHECK(fired == n);
+
+            ks_ecs_destroy_world(world);
+        }
+    }
+
+    SUBCASE("Lua Systems: Per-Entity vs Batch") {
+        for (int n : k_bench_sizes) {
+            Ks_Script_Ctx ctx = ks_script_create_ctx();
+            ks_types_lua_bind(ctx);
+            Ks_Ecs_World world = ks_ecs_create_world();
+            ks_ecs_lua_bind(world, ctx);
+
+            auto b = ks_script_usertype_begin_from_ref(ctx, ks_type_id(BenchPosition));
+            REQUIRE(b != nullptr);
+            ks_script_usertype_end(b);
+
+            bench_populate(world, n);
+
+            auto res = ks_script_do_cstring(ctx, R"(
+                ecs.System("BenchLuaEach", "OnUpdate", "BenchPosition", function(e)
+                    local p = e:get("BenchPosition")
+                    p.x = p.x + 1
+                end)
+            )");
+            REQUIRE(ks_script_call_succeded(ctx, res));
+
+            double ms = bench_ms([&]() { ks_ecs_progress(world, 0.016f); });
+            bench_report("lua_system_each", n, ms);
+
+            ks_ecs_enable_system(world, ks_ecs_lookup(world, "BenchLuaEach"), false);
+            res = ks_script_do_cstring(ctx, R"(
+                ecs.BatchSystem("BenchLuaBatch", "OnUpdate", "BenchPosition", function(count, ids, pos)
+                    local px = pos.x
+                    for i = 1, count do
+                        px[i] = px[i] + 1
+                    end
+                end)
+            )");
+            REQUIRE(ks_script_call_succeded(ctx, res));
+
+            ms = bench_ms([&]() { ks_ecs_progress(world, 0.016f); });
+            bench_report("lua_system_batch", n, ms);
+
+            ks_ecs_lua_shutdown(world);
+            ks_ecs_destroy_world(world);
+            ks_script_destroy_ctx(ctx);
+        }
+    }
+
+    ks_reflection_shutdown();
+    ks_memory_shutdown();
+}
@@ -134,7 +134,7 @@ TEST_CASE("Bindings: ECS Integration") {
         const char* script = R"(
             local OrcInfo = ecs.Component("OrcInfo", { rank = 1 })
 
-            local OrcPrefab = ecs.Prefab("OrcBase", {
+            OrcPrefab = ecs.Prefab("OrcBase", {
                 OrcInfo { rank = 1 },
                 Position()
             })
@@ -149,12 +149,251 @@ TEST_CASE("Bindings: ECS Integration") {
             local grunt2 = ecs.instantiate("OrcBase")
             if grunt2:get("OrcInfo").rank ~= 1 then return -2 end
             
+            untouched = ecs.instantiate("OrcBase")
             return 1
         )";
 
         auto res = ks_script_do_cstring(ctx, script);
         CHECK(ks_script_call_succeded(ctx, res));
         CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 1);
+
+        // C sees the prefab's plain registry ref, not a tagged one.
+        const int* prefab_ref = (const int*)ks_ecs_get_component(world, ks_ecs_lookup(world, "OrcBase"), "OrcInfo");
+        REQUIRE(prefab_ref != nullptr);
+        CHECK(*prefab_ref > 0);
+        CHECK(*prefab_ref < 0x40000000);
+
+        // Instances that never touched the shared table keep a copy of it.
+        res = ks_script_do_cstring(ctx, R"(
+            OrcPrefab:destroy()
+            collectgarbage()
+            return untouched:get("OrcInfo").rank
+        )");
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 1);
+    }
+
+    SUBCASE("Batch Instantiation") {
+        const char* script = R"(
+            local Ammo = ecs.Component("Ammo", { count = 0 })
+            local proto = ecs.Prefab("Shell", { Ammo { count = 6 }, Position(0, 0) })
+
+            local shells = ecs.instantiate(proto, 500)
+            if #shells ~= 500 then return -1 end
+
+            shells[1]:get("Ammo").count = 1
+            if shells[2]:get("Ammo").count ~= 6 then return -2 end
+            if proto:get("Ammo").count ~= 6 then return -3 end
+
+            shells[3]:destroy()
+            if proto:get("Ammo").count ~= 6 then return -4 end
+
+            return shells[1]:get("Ammo").count + shells[500]:get("Ammo").count
+        )";
+
+        auto res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 7);
+    }
+
+    SUBCASE("Bulk Entities") {
+        const char* script = R"(
+            local Stats = ecs.Component("Stats", { lvl = 1 })
+
+            local list = ecs.Entities(10, {
+                Position(1, 2),
+                Stats { lvl = 3 }
+            })
+            if #list ~= 10 then return -1 end
+
+            list[1]:get("Stats").lvl = 7
+            if list[2]:get("Stats").lvl ~= 3 then return -2 end
+
+            local total = 0
+            for i = 1, #list do
+                total = total + list[i]:get("Position").y
+            end
+            return total
+        )";
+
+        auto res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 20);
+    }
+
+    SUBCASE("Batch Systems") {
+        const char* script = R"(
+            local Stats = ecs.Component("Stats", { lvl = 1 })
+            batch_calls = 0
+            batch_seen = 0
+
+            first = ecs.Entities(100, { Position(1, 2), Stats { lvl = 0 } })[1]
+
+            ecs.BatchSystem("BatchMover", "OnUpdate", "Position, Stats", function(count, ids, pos, stats)
+                batch_calls = batch_calls + 1
+                local px = pos.x
+                for i = 1, count do
+                    px[i] = px[i] + 1
+                    stats[i].lvl = stats[i].lvl + 1
+                    if ids[i] ~= 0 then batch_seen = batch_seen + 1 end
+                end
+            end)
+        )";
+
+        auto res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+
+        ks_ecs_progress(world, 0.016f);
+
+        res = ks_script_do_cstring(ctx, "return batch_calls");
+        CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 1);
+
+        res = ks_script_do_cstring(ctx, "return batch_seen");
+        CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 100);
+
+        res = ks_script_do_cstring(ctx, "return first:get('Position').x + first:get('Stats').lvl");
+        CHECK(ks_script_obj_as_number(ctx, ks_script_call_get_return(ctx, res)) == doctest::Approx(3.0));
+    }
+
+    SUBCASE("Snapshot Script Components") {
+        const char* script = R"(
+            local Health = ecs.Component("Health", { hp = 100 })
+            knight = ecs.Entity("Knight", { Health { hp = 75, tags = { "brave", "loyal" } } })
+        )";
+        auto res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+
+        ks_size size = 0;
+        void* snapshot = ks_ecs_snapshot_save(world, &size);
+        REQUIRE(snapshot != nullptr);
+
+        ks_script_do_cstring(ctx, "knight:get('Health').hp = 1");
+        CHECK(ks_ecs_snapshot_load(world, snapshot, size));
+        ks_ecs_snapshot_free(snapshot);
+
+        res = ks_script_do_cstring(ctx, R"(
+            local h = knight:get("Health")
+            if h.tags[2] ~= "loyal" then return -1 end
+            return h.hp
+        )");
+        CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 75);
+    }
+
+    SUBCASE("Native Layout Script Components") {
+        const char* script = R"(
+            local Mana = ecs.Component("Mana", { amount = 50, regen = 1.5 }, { amount = "int", regen = "float", frozen = "bool" })
+
+            local mage = ecs.Entity("Mage", { Mana { amount = 80 } })
+            local m = mage:get("Mana")
+            if m.amount ~= 80 or m.regen ~= 1.5 or m.frozen then return -1 end
+
+            m.amount = 95
+            if mage:get("Mana").amount ~= 95 then return -2 end
+
+            local proto = ecs.Prefab("ManaWell", { Mana {} })
+            local well = ecs.instantiate(proto)
+            if well:get("Mana").amount ~= 50 then return -3 end
+
+            local list = ecs.Entities(8, { Mana { regen = 2 } })
+            local total = 0
+            for i = 1, #list do total = total + list[i]:get("Mana").regen end
+            return total
+        )";
+
+        auto res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_number(ctx, ks_script_call_get_return(ctx, res)) == doctest::Approx(16.0));
+
+        const Ks_Type_Info* info = ks_reflection_get_type("Mana");
+        REQUIRE(info != nullptr);
+        CHECK(info->size == 12);
+
+        Ks_Entity mage = ks_ecs_lookup(world, "Mage");
+        const ks_int* amount = (const ks_int*)ks_ecs_get_component(world, mage, "Mana");
+        REQUIRE(amount != nullptr);
+        CHECK(*amount == 95);
+
+        // Used before its layout existed, so the world holds it as an int.
+        ks_ecs_component_id(world, "Ward");
+        res = ks_script_do_cstring(ctx, "return ecs.Component('Ward', {}, { power = 'double' }) == nil");
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_boolean(ctx, ks_script_call_get_return(ctx, res)));
+
+        res = ks_script_do_cstring(ctx, "return ecs.Component('Mana', {}, { amount = 'double' }) == nil");
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_boolean(ctx, ks_script_call_get_return(ctx, res)));
+
+        // Another context shares the layout but gets its own usertype and defaults.
+        Ks_Script_Ctx other_ctx = ks_script_create_ctx();
+        Ks_Ecs_World other = ks_ecs_create_world();
+        ks_ecs_lua_bind(other, other_ctx);
+
+        res = ks_script_do_cstring(other_ctx, R"(
+            local Mana = ecs.Component("Mana", { amount = 7 }, { amount = "int", regen = "float", frozen = "bool" })
+            local sage = ecs.Entity("Sage", { Mana {} })
+            local m = sage:get("Mana")
+            m.regen = 4
+            return m.amount + sage:get("Mana").regen
+        )");
+        CHECK(ks_script_call_succeded(other_ctx, res));
+        CHECK(ks_script_obj_as_number(other_ctx, ks_script_call_get_return(other_ctx, res)) == doctest::Approx(11.0));
+
+        ks_ecs_destroy_world(other);
+        ks_script_destroy_ctx(other_ctx);
+    }
+
+    SUBCASE("Spatial Queries") {
+        const char* script = R"(
+            local grid = ecs.Spatial("Position", 4)
+            for i = 0, 9 do
+                ecs.Entity(nil, { Position(i * 2, 0) })
+            end
+            if grid:count() ~= 10 then return -1 end
+
+            local near = grid:radius(0, 0, 0, 2.5)
+            if #near ~= 2 then return -2 end
+
+            local box = grid:aabb(5, -1, 0, 11, 1, 0)
+            if #box ~= 3 then return -3 end
+
+            local closest = grid:nearest(17.5, 0, 0, 1)
+            return closest[1]:get("Position").x
+        )";
+
+        auto res = ks_script_do_cstring(ctx, script);
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_number(ctx, ks_script_call_get_return(ctx, res)) == doctest::Approx(18.0));
+    }
+
+    SUBCASE("Query Handles Outlive Their World") {
+        Ks_Script_Ctx other_ctx = ks_script_create_ctx();
+        Ks_Ecs_World other = ks_ecs_create_world();
+        ks_ecs_lua_bind(other, other_ctx);
+
+        Ks_Script_Function_Call_Result res = ks_script_do_cstring(other_ctx, R"(
+            local Tag = ecs.Component("OtherTag")
+            ecs.Entity("O1", { Tag{} })
+            local hits = 0
+            ecs.Query("OtherTag", function(e) hits = hits + 1 end)
+            other_query = ecs.Query("OtherTag")
+            return hits
+        )");
+        CHECK(ks_script_call_succeded(other_ctx, res));
+        CHECK(ks_script_obj_as_integer(other_ctx, ks_script_call_get_return(other_ctx, res)) == 1);
+
+        ks_ecs_destroy_world(other);
+
+        res = ks_script_do_cstring(other_ctx, R"(
+            local hits = 0
+            other_query:each(function(e) hits = hits + 1 end)
+            other_query = nil
+            collectgarbage()
+            return hits
+        )");
+        CHECK(ks_script_call_succeded(other_ctx, res));
+        CHECK(ks_script_obj_as_integer(other_ctx, ks_script_call_get_return(other_ctx, res)) == 0);
+
+        ks_script_destroy_ctx(other_ctx);
     }
 
     SUBCASE("Entity Lifecycle: Destroy") {
@@ -318,6 +557,18 @@ TEST_CASE("Bindings: ECS Integration") {
 
         ks_script_do_cstring(ctx, "return run_query_checks()");
 
+        res = ks_script_do_cstring(ctx, R"(
+            local q = ecs.Query("TagA")
+            local total = 0
+            for i = 1, 3 do
+                q:each(function(e) total = total + 1 end)
+            end
+            q:destroy()
+            return total
+        )");
+        CHECK(ks_script_call_succeded(ctx, res));
+        CHECK(ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res)) == 6);
+
         res = ks_script_do_cstring(ctx, "c_a, c_ab = run_query_checks(); return c_a");
         int count_a = (int)ks_script_obj_as_integer(ctx, ks_script_call_get_return(ctx, res));
         CHECK(count_a == 2);
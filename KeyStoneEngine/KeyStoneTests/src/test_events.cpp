@@ -3,6 +3,8 @@
 #include <string.h>
 #include <string>
 #include <vector>
+#include <thread>
+#include <atomic>
 
 struct TestDataEvent {
     int x, y;
@@ -72,6 +74,73 @@ void on_user_data_check(Ks_EventData data, void* user_data) {
     (*val)++;
 }
 
+struct SelfUnsubscribe {
+    Ks_EventManager em;
+    Ks_Handle sub;
+    int calls;
+    int freed;
+};
+
+void on_self_unsubscribe(Ks_EventData data, void* user_data) {
+    SelfUnsubscribe* s = (SelfUnsubscribe*)user_data;
+    s->calls++;
+    ks_event_manager_unsubscribe(s->em, s->sub);
+}
+
+struct BatchStats {
+    int calls;
+    int events;
+    int sum_x;
+};
+
+void on_data_batch(Ks_EventData data, ks_size count, void* user_data) {
+    BatchStats* stats = (BatchStats*)user_data;
+    const TestDataEvent* evts = (const TestDataEvent*)data;
+    stats->calls++;
+    for (ks_size i = 0; i < count; ++i) {
+        stats->events++;
+        stats->sum_x += evts[i].x;
+    }
+}
+
+struct ThreadOrderCheck {
+    int last_y[4];
+    int events;
+    bool ordered;
+};
+
+void on_thread_batch(Ks_EventData data, ks_size count, void* user_data) {
+    ThreadOrderCheck* check = (ThreadOrderCheck*)user_data;
+    const TestDataEvent* evts = (const TestDataEvent*)data;
+    for (ks_size i = 0; i < count; ++i) {
+        if (evts[i].y <= check->last_y[evts[i].x]) check->ordered = false;
+        check->last_y[evts[i].x] = evts[i].y;
+        check->events++;
+    }
+}
+
+struct HeldPublish {
+    std::atomic<bool> entered;
+    std::atomic<bool> release;
+};
+
+void on_held_publish(Ks_EventData data, void* user_data) {
+    HeldPublish* held = (HeldPublish*)user_data;
+    held->entered = true;
+    while (!held->release) std::this_thread::yield();
+}
+
+struct ChainedSignal {
+    Ks_EventManager em;
+    Ks_Handle next;
+};
+
+void on_chained_signal(Ks_EventData data, void* user_data) {
+    ChainedSignal* chain = (ChainedSignal*)user_data;
+    ks_event_manager_emit(chain->em, chain->next);
+    ks_event_manager_enqueue(chain->em, chain->next, nullptr, 0);
+}
+
 TEST_CASE("C API: Event Manager") {
     ks_memory_init();
     ks_reflection_init();
@@ -169,6 +238,285 @@ TEST_CASE("C API: Event Manager") {
         CHECK(g_callback_count == 3);
     }
 
+    SUBCASE("Queued Dispatch") {
+        Ks_Handle data_e = ks_event_manager_register_type(em, ks_type_id(TestDataEvent));
+        Ks_Handle tick_e = ks_event_manager_register_signal(em, "QueuedTick");
+
+        BatchStats stats = { 0, 0, 0 };
+        ks_event_manager_subscribe_batch(em, data_e, on_data_batch, &stats);
+        ks_event_manager_subscribe(em, data_e, on_data_event, nullptr);
+        ks_event_manager_subscribe(em, tick_e, on_signal_event, nullptr);
+
+        for (int i = 1; i <= 10; ++i) {
+            TestDataEvent evt = {};
+            evt.x = i;
+            ks_event_manager_enqueue(em, data_e, &evt, sizeof(evt));
+            ks_event_manager_enqueue(em, tick_e, nullptr, 0);
+        }
+        CHECK(g_callback_count == 0);
+        CHECK(stats.calls == 0);
+
+        int bad = 0;
+        ks_event_manager_enqueue(em, data_e, &bad, sizeof(bad));
+
+        ks_event_manager_dispatch_queued(em);
+        CHECK(stats.calls == 1);
+        CHECK(stats.events == 10);
+        CHECK(stats.sum_x == 55);
+        CHECK(g_callback_count == 20);
+        CHECK(g_received_data.x == 10);
+
+        ks_event_manager_dispatch_queued(em);
+        CHECK(stats.calls == 1);
+
+        TestDataEvent direct = {};
+        direct.x = 7;
+        ks_event_manager_publish(em, data_e, &direct);
+        CHECK(stats.calls == 2);
+        CHECK(stats.sum_x == 62);
+    }
+
+    SUBCASE("Queued Dispatch From Threads") {
+        Ks_Handle data_e = ks_event_manager_register_type(em, ks_type_id(TestDataEvent));
+        ks_event_manager_set_sequenced(em, true);
+
+        ThreadOrderCheck check = { { -1, -1, -1, -1 }, 0, true };
+        ks_event_manager_subscribe_batch(em, data_e, on_thread_batch, &check);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([em, data_e, t]() {
+                for (int i = 0; i < 5000; ++i) {
+                    TestDataEvent evt = {};
+                    evt.x = t;
+                    evt.y = i;
+                    ks_event_manager_enqueue(em, data_e, &evt, sizeof(evt));
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        CHECK(check.events == 0);
+
+        ks_event_manager_dispatch_queued(em);
+        CHECK(check.events == 20000);
+        CHECK(check.ordered);
+        for (int t = 0; t < 4; ++t) CHECK(check.last_y[t] == 4999);
+    }
+
+    SUBCASE("Subscriber Churn") {
+        Ks_Handle churn_e = ks_event_manager_register_signal(em, "Churn");
+
+        std::vector<Ks_Handle> subs;
+        for (int i = 0; i < 1000; ++i) {
+            subs.push_back(ks_event_manager_subscribe(em, churn_e, on_signal_event, nullptr));
+        }
+        for (int i = 0; i < 1000; i += 2) {
+            ks_event_manager_unsubscribe(em, subs[i]);
+        }
+
+        ks_event_manager_emit(em, churn_e);
+        CHECK(g_callback_count == 500);
+
+        // Stale handles are rejected even after their slot is reused.
+        Ks_Handle reused = ks_event_manager_subscribe(em, churn_e, on_signal_event, nullptr);
+        CHECK(reused != subs[0]);
+        ks_event_manager_unsubscribe(em, subs[0]);
+
+        ks_event_manager_emit(em, churn_e);
+        CHECK(g_callback_count == 500 + 501);
+    }
+
+    SUBCASE("Keyed Subscriptions") {
+        Ks_Handle damage_e = ks_event_manager_register_type(em, ks_type_id(TestDataEvent));
+
+        int hits[3] = { 0, 0, 0 };
+        ks_event_manager_subscribe_keyed(em, damage_e, 100, on_user_data_check, &hits[0], nullptr);
+        Ks_Handle sub_b = ks_event_manager_subscribe_keyed(em, damage_e, 200, on_user_data_check, &hits[1], nullptr);
+        ks_event_manager_subscribe_keyed(em, damage_e, 200, on_user_data_check, &hits[2], nullptr);
+        ks_event_manager_subscribe(em, damage_e, on_data_event, nullptr);
+
+        TestDataEvent evt = {};
+        evt.x = 5;
+        ks_event_manager_publish_keyed(em, damage_e, 200, &evt);
+        CHECK(hits[0] == 0);
+        CHECK(hits[1] == 1);
+        CHECK(hits[2] == 1);
+        CHECK(g_callback_count == 1);
+
+        ks_event_manager_publish_keyed(em, damage_e, 300, &evt);
+        ks_event_manager_publish(em, damage_e, &evt);
+        CHECK(hits[0] + hits[1] + hits[2] == 2);
+        CHECK(g_callback_count == 3);
+
+        ks_event_manager_unsubscribe(em, sub_b);
+        ks_event_manager_publish_keyed(em, damage_e, 200, &evt);
+        ks_event_manager_publish_keyed(em, damage_e, 100, &evt);
+        CHECK(hits[0] == 1);
+        CHECK(hits[1] == 1);
+        CHECK(hits[2] == 2);
+    }
+
+    SUBCASE("Coalescing Channels") {
+        Ks_Handle moved_e = ks_event_manager_register_type_ex(em, ks_type_id(TestDataEvent), KS_EVENT_COALESCE_LATEST_PER_KEY);
+        Ks_Handle changed_e = ks_event_manager_register_signal_ex(em, "SettingChanged", KS_EVENT_COALESCE_LATEST);
+
+        int released = 0;
+        ks_event_manager_set_queued_release(em, moved_e, on_user_data_check, &released);
+
+        BatchStats stats = { 0, 0, 0 };
+        int key_hits = 0;
+        ks_event_manager_subscribe_batch(em, moved_e, on_data_batch, &stats);
+        ks_event_manager_subscribe_keyed(em, moved_e, 7, on_user_data_check, &key_hits, nullptr);
+        ks_event_manager_subscribe(em, changed_e, on_signal_event, nullptr);
+
+        for (int i = 1; i <= 5; ++i) {
+            TestDataEvent evt = {};
+            evt.x = i;
+            ks_event_manager_enqueue_keyed(em, moved_e, 7, &evt, sizeof(evt));
+            evt.x = i * 10;
+            ks_event_manager_enqueue_keyed(em, moved_e, 8, &evt, sizeof(evt));
+            ks_event_manager_enqueue(em, changed_e, nullptr, 0);
+        }
+
+        ks_event_manager_dispatch_queued(em);
+        CHECK(stats.calls == 1);
+        CHECK(stats.events == 2);
+        CHECK(stats.sum_x == 55);
+        CHECK(key_hits == 1);
+        CHECK(g_callback_count == 1);
+        CHECK(released == 10);
+
+        TestDataEvent evt = {};
+        ks_event_manager_publish(em, moved_e, &evt);
+        ks_event_manager_publish(em, moved_e, &evt);
+        CHECK(stats.events == 4);
+        CHECK(released == 10);
+    }
+
+    SUBCASE("Recording & Replay") {
+        Ks_Handle data_e = ks_event_manager_register_type(em, ks_type_id(TestDataEvent));
+        Ks_Handle prim_e = ks_event_manager_register_type(em, ks_type_id(TestPrimitiveEvent));
+        Ks_Handle tick_e = ks_event_manager_register_signal(em, "ReplayTick");
+
+        Ks_EventLog log = ks_event_log_create();
+        ks_event_manager_record_start(em, log);
+
+        TestDataEvent evt = {};
+        evt.x = 3;
+        strcpy(evt.name, "recorded");
+        ks_event_manager_publish(em, data_e, &evt);
+        ks_event_manager_publish_keyed(em, data_e, 42, &evt);
+        ks_event_manager_enqueue(em, data_e, &evt, sizeof(evt));
+        ks_event_manager_emit(em, tick_e);
+        TestPrimitiveEvent prim = { 1, 2.0f, "not replayable" };
+        ks_event_manager_publish(em, prim_e, &prim);
+        ks_event_manager_dispatch_queued(em);
+
+        ks_event_manager_record_stop(em);
+        ks_event_manager_emit(em, tick_e);
+        CHECK(ks_event_log_count(log) == 6);
+
+        ks_size size = 0;
+        void* bytes = ks_event_log_save(log, &size);
+        REQUIRE(bytes != nullptr);
+        ks_event_log_destroy(log);
+
+        CHECK(ks_event_log_load(bytes, size / 2) == nullptr);
+        Ks_EventLog loaded = ks_event_log_load(bytes, size);
+        ks_event_log_free(bytes);
+        REQUIRE(loaded != nullptr);
+        CHECK(ks_event_log_count(loaded) == 6);
+
+        Ks_EventManager replay_em = ks_event_manager_create();
+        Ks_Handle replay_tick = ks_event_manager_register_signal(replay_em, "ReplayTick");
+        Ks_Handle replay_data = ks_event_manager_register_type(replay_em, ks_type_id(TestDataEvent));
+        ks_event_manager_register_type(replay_em, ks_type_id(TestPrimitiveEvent));
+
+        int keyed_hits = 0;
+        int prim_hits = 0;
+        ks_event_manager_subscribe(replay_em, replay_data, on_data_event, nullptr);
+        ks_event_manager_subscribe_keyed(replay_em, replay_data, 42, on_user_data_check, &keyed_hits, nullptr);
+        ks_event_manager_subscribe(replay_em, replay_tick, on_signal_event, nullptr);
+        ks_event_manager_subscribe(replay_em, ks_event_manager_get_event_handle(replay_em, ks_type_id(TestPrimitiveEvent)), on_user_data_check, &prim_hits);
+
+        reset_test_globals();
+        CHECK(ks_event_log_replay(loaded, replay_em, KS_EVENT_REPLAY_MAX) == 4);
+        CHECK(g_callback_count == 4);
+        CHECK(keyed_hits == 1);
+        CHECK(prim_hits == 0);
+        CHECK(g_received_data.x == 3);
+        CHECK(strcmp(g_received_data.name, "recorded") == 0);
+
+        ks_event_log_destroy(loaded);
+        ks_event_manager_destroy(replay_em);
+    }
+
+    SUBCASE("Recording Skips Nested Events") {
+        Ks_Handle outer_e = ks_event_manager_register_signal(em, "ChainOuter");
+        Ks_Handle inner_e = ks_event_manager_register_signal(em, "ChainInner");
+        ChainedSignal chain = { em, inner_e };
+        ks_event_manager_subscribe(em, outer_e, on_chained_signal, &chain);
+
+        Ks_EventLog log = ks_event_log_create();
+        ks_event_manager_record_start(em, log);
+        ks_event_manager_emit(em, outer_e);
+        ks_event_manager_enqueue(em, outer_e, nullptr, 0);
+        ks_event_manager_dispatch_queued(em);
+        ks_event_manager_record_stop(em);
+
+        // The outer emit, the outer enqueue and the dispatch marker; the
+        // inner events come back when the outer ones are replayed.
+        CHECK(ks_event_log_count(log) == 3);
+        ks_event_log_destroy(log);
+    }
+
+    SUBCASE("Unsubscribe During Publish") {
+        Ks_Handle ping_e = ks_event_manager_register_signal(em, "Ping");
+
+        SelfUnsubscribe state = { em, KS_INVALID_HANDLE, 0, 0 };
+        state.sub = ks_event_manager_subscribe_ex(em, ping_e, on_self_unsubscribe, &state, [](void* d) {
+            ((SelfUnsubscribe*)d)->freed++;
+            });
+        ks_event_manager_subscribe(em, ping_e, on_signal_event, nullptr);
+
+        // The emit that unsubscribed is the last one in flight, so it frees
+        // the user data on its way out.
+        ks_event_manager_emit(em, ping_e);
+        CHECK(state.calls == 1);
+        CHECK(g_callback_count == 1);
+        CHECK(state.freed == 1);
+
+        ks_event_manager_emit(em, ping_e);
+        CHECK(state.calls == 1);
+        CHECK(g_callback_count == 2);
+    }
+
+    SUBCASE("Unsubscribe While Another Publish Is In Flight") {
+        Ks_Handle hold_e = ks_event_manager_register_signal(em, "Hold");
+        Ks_Handle ping_e = ks_event_manager_register_signal(em, "Ping");
+
+        HeldPublish held;
+        held.entered = false;
+        held.release = false;
+        ks_event_manager_subscribe(em, hold_e, on_held_publish, &held);
+
+        int freed = 0;
+        Ks_Handle sub = ks_event_manager_subscribe_ex(em, ping_e, on_signal_event, &freed, [](void* d) { (*(int*)d)++; });
+
+        std::thread holder([&]() { ks_event_manager_emit(em, hold_e); });
+        while (!held.entered) std::this_thread::yield();
+
+        ks_event_manager_unsubscribe(em, sub);
+        ks_event_manager_emit(em, ping_e);
+        CHECK(g_callback_count == 0);
+        CHECK(freed == 0);
+
+        held.release = true;
+        holder.join();
+        ks_event_manager_dispatch_queued(em);
+        CHECK(freed == 1);
+    }
+
     ks_event_manager_destroy(em);
     ks_reflection_shutdown();
     ks_memory_shutdown();
@@ -3,6 +3,11 @@
 #include <chrono>
 #include <vector>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <string>
+
+#include "../include/common.h"
 
 template<typename Func>
 long long measure_ms(Func&& f) {
@@ -16,6 +21,10 @@ ks_returns_count vec3_ctor_bench(Ks_Script_Ctx ctx) {
     return 0;
 }
 
+static void native_event_bench(Ks_EventData data, void* user_data) {
+    (*(std::atomic<int>*)user_data).fetch_add(1, std::memory_order_relaxed);
+}
+
 TEST_CASE("Performance Benchmarks") {
     ks_memory_init();
     ks_reflection_init();
@@ -48,6 +57,76 @@ TEST_CASE("Performance Benchmarks") {
         KS_LOG_TRACE("[PERF] 100k Event Publishes (Lua->C++->Lua): %lld ms", duration);
     }
 
+    SUBCASE("Benchmark: Native Event Publish (100k publishes)") {
+        Ks_Handle tick = ks_event_manager_register_signal(em, "PerfTick");
+        std::atomic<int> hits{ 0 };
+        for (int i = 0; i < 4; ++i) {
+            ks_event_manager_subscribe(em, tick, native_event_bench, &hits);
+        }
+
+        long long duration = measure_ms([&]() {
+            for (int i = 0; i < 100000; ++i) {
+                ks_event_manager_emit(em, tick);
+            }
+            });
+        CHECK(hits.load() == 400000);
+        KS_LOG_TRACE("[PERF] 100k Native Event Publishes (4 subscribers): %lld ms", duration);
+
+        hits = 0;
+        duration = measure_ms([&]() {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([&]() {
+                    for (int i = 0; i < 100000; ++i) {
+                        ks_event_manager_emit(em, tick);
+                    }
+                });
+            }
+            for (auto& t : threads) t.join();
+            });
+        CHECK(hits.load() == 1600000);
+        KS_LOG_TRACE("[PERF] 4x100k Concurrent Native Event Publishes (4 subscribers): %lld ms", duration);
+    }
+
+    SUBCASE("Benchmark: Concurrent Asset Lookups (4x100k get_data)") {
+        Ks_AssetsManager am = ks_assets_manager_create();
+        Ks_IAsset iface = {};
+        iface.load_from_file_fn = my_asset_load_file;
+        iface.destroy_fn = my_asset_destroy;
+        ks_assets_manager_register_asset_type(am, "PerfAsset", iface);
+
+        std::vector<Ks_Handle> handles;
+        for (int i = 0; i < 1000; ++i) {
+            std::string name = "perf_asset_" + std::to_string(i);
+            handles.push_back(ks_assets_manager_load_asset_from_file(am, "PerfAsset", name.c_str(), name.c_str()));
+        }
+
+        std::atomic<int> misses{ 0 };
+        auto lookups = [&]() {
+            for (int i = 0; i < 100000; ++i) {
+                if (!ks_assets_manager_get_data(am, handles[i % handles.size()])) {
+                    misses.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        long long duration = measure_ms(lookups);
+        KS_LOG_TRACE("[PERF] 100k Asset Lookups: %lld ms", duration);
+
+        duration = measure_ms([&]() {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back(lookups);
+            }
+            for (auto& t : threads) t.join();
+            });
+        CHECK(misses.load() == 0);
+        KS_LOG_TRACE("[PERF] 4x100k Concurrent Asset Lookups: %lld ms", duration);
+
+        for (Ks_Handle h : handles) ks_assets_manager_asset_release(am, h);
+        ks_assets_manager_destroy(am);
+    }
+
     SUBCASE("Benchmark: Userdata Creation (100k allocs)") {
         auto b = ks_script_usertype_begin(ctx, "Vec3", 12);
         ks_script_usertype_add_constructor(b, KS_SCRIPT_FUNC_VOID(vec3_ctor_bench));